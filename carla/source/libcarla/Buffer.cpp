@@ -0,0 +1,345 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <boost/python/def_visitor.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// Description of a block of memory exported through the Python buffer
+/// protocol (PEP 3118). The memory is owned by the exporting object, the
+/// buffer protocol takes care of keeping the exporter alive while any view
+/// is in use.
+struct BufferLayout {
+
+  void *data = nullptr;
+
+  /// struct-module style format string of a single item.
+  std::string format;
+
+  Py_ssize_t itemsize = 0;
+
+  /// Extent of each dimension, the memory is always C-contiguous.
+  std::vector<Py_ssize_t> shape;
+
+  bool readonly = false;
+};
+
+/// Builds the format string of a structured item, e.g. "T{=f:x:f:y:}". Gaps
+/// between fields are filled with explicit padding bytes so the result does
+/// not depend on the packing rules of the consumer.
+class StructFormat {
+public:
+
+  StructFormat &Field(size_t offset, const char *code, size_t size, const char *name) {
+    Pad(offset);
+    _format += code;
+    _format += ':';
+    _format += name;
+    _format += ':';
+    _offset = offset + size;
+    return *this;
+  }
+
+  std::string Build(size_t itemsize) {
+    Pad(itemsize);
+    return "T{=" + _format + "}";
+  }
+
+private:
+
+  void Pad(size_t offset) {
+    if (offset > _offset) {
+      _format += std::to_string(offset - _offset) + "x";
+      _offset = offset;
+    }
+  }
+
+  std::string _format;
+
+  size_t _offset = 0u;
+};
+
+/// Specialize for each type exported with BufferProtocol, providing
+///
+///   static BufferLayout Describe(T &self);
+template <typename T>
+struct BufferTraits;
+
+namespace buffer_impl {
+
+  // Storage for the format, shape, and strides, kept in Py_buffer::internal
+  // until the consumer releases the view.
+  struct ExportedLayout {
+    std::string format;
+    std::vector<Py_ssize_t> shape;
+    std::vector<Py_ssize_t> strides;
+  };
+
+  static int FillBuffer(PyObject *exporter, Py_buffer *view, int flags, BufferLayout layout) {
+    if (((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) && layout.readonly) {
+      PyErr_SetString(PyExc_BufferError, "buffer is not writable");
+      view->obj = nullptr;
+      return -1;
+    }
+    auto *exported = new ExportedLayout{std::move(layout.format), std::move(layout.shape), {}};
+    exported->strides.resize(exported->shape.size());
+    Py_ssize_t length = layout.itemsize;
+    for (auto i = exported->shape.size(); i > 0u; --i) {
+      exported->strides[i - 1u] = length;
+      length *= exported->shape[i - 1u];
+    }
+    view->buf = layout.data;
+    view->obj = exporter;
+    Py_INCREF(exporter);
+    view->len = length;
+    view->readonly = layout.readonly ? 1 : 0;
+    view->itemsize = layout.itemsize;
+    view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ?
+        const_cast<char *>(exported->format.c_str()) :
+        nullptr;
+    view->ndim = static_cast<int>(exported->shape.size());
+    view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? exported->shape.data() : nullptr;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? exported->strides.data() : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = exported;
+    return 0;
+  }
+
+  template <typename T>
+  static int GetBuffer(PyObject *exporter, Py_buffer *view, int flags) {
+    if (view == nullptr) {
+      PyErr_SetString(PyExc_BufferError, "invalid buffer view");
+      return -1;
+    }
+    boost::python::extract<T &> self(exporter);
+    if (!self.check()) {
+      PyErr_SetString(PyExc_BufferError, "object does not export a buffer");
+      view->obj = nullptr;
+      return -1;
+    }
+    try {
+      return FillBuffer(exporter, view, flags, BufferTraits<T>::Describe(self()));
+    } catch (...) {
+      boost::python::handle_exception();
+      view->obj = nullptr;
+      return -1;
+    }
+  }
+
+  static void ReleaseBuffer(PyObject *, Py_buffer *view) {
+    delete static_cast<ExportedLayout *>(view->internal);
+  }
+
+  template <typename T>
+  static PyBufferProcs *GetBufferProcs() {
+    static PyBufferProcs procs = [] {
+      PyBufferProcs result{};
+      result.bf_getbuffer = &GetBuffer<T>;
+      result.bf_releasebuffer = &ReleaseBuffer;
+      return result;
+    }();
+    return &procs;
+  }
+
+} // namespace buffer_impl
+
+/// Visitor that makes a class_ implement the Python buffer protocol, so
+/// memoryview(obj) and numpy.asarray(obj) get a typed view of its memory
+/// without copying it. The layout is taken from BufferTraits<T>.
+class BufferProtocol : public boost::python::def_visitor<BufferProtocol> {
+  friend class boost::python::def_visitor_access;
+
+  template <typename ClassT>
+  void visit(ClassT &cls) const {
+    using T = typename ClassT::wrapped_type;
+    auto *type = reinterpret_cast<PyTypeObject *>(cls.ptr());
+    type->tp_as_buffer = buffer_impl::GetBufferProcs<T>();
+#if PY_MAJOR_VERSION < 3
+    type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+    PyType_Modified(type);
+  }
+};
+
+/// Memory exported through the buffer protocol on behalf of another object.
+/// Keeps @a owner alive for as long as the buffer, or any view of it, is in
+/// use.
+class ArrayBuffer {
+public:
+
+  ArrayBuffer(boost::python::object owner, BufferLayout layout)
+    : _owner(std::move(owner)),
+      _layout(std::move(layout)) {}
+
+  const BufferLayout &GetLayout() const {
+    return _layout;
+  }
+
+private:
+
+  boost::python::object _owner;
+
+  BufferLayout _layout;
+};
+
+template <>
+struct BufferTraits<ArrayBuffer> {
+  static BufferLayout Describe(ArrayBuffer &self) {
+    return self.GetLayout();
+  }
+};
+
+/// View of the memory of an object implementing the buffer protocol, e.g. a
+/// NumPy array, released on destruction. Throws if the object does not
+/// provide a buffer compatible with @a flags.
+///
+/// @warning The GIL must be held when this object is created and destroyed.
+class ScopedBuffer : private boost::noncopyable {
+public:
+
+  ScopedBuffer(const boost::python::object &object, int flags) {
+    if (PyObject_GetBuffer(object.ptr(), &_view, flags) != 0) {
+      boost::python::throw_error_already_set();
+    }
+  }
+
+  ~ScopedBuffer() {
+    PyBuffer_Release(&_view);
+  }
+
+  void *data() const {
+    return _view.buf;
+  }
+
+  /// Size in bytes.
+  size_t size() const {
+    return static_cast<size_t>(_view.len);
+  }
+
+  const Py_buffer &view() const {
+    return _view;
+  }
+
+private:
+
+  Py_buffer _view;
+};
+
+/// Returns a memoryview with the given layout that keeps @a owner alive.
+static boost::python::object MakeMemoryView(boost::python::object owner, BufferLayout layout) {
+  namespace py = boost::python;
+  py::object buffer{ArrayBuffer{std::move(owner), std::move(layout)}};
+  return py::object(py::handle<>(PyMemoryView_FromObject(buffer.ptr())));
+}
+
+/// Allocates a new writable array with the given layout, exported as a
+/// memoryview of memory owned by a Python bytearray. On return, layout.data
+/// points to the uninitialized memory of the array.
+static boost::python::object MakeArray(BufferLayout &layout) {
+  namespace py = boost::python;
+  Py_ssize_t size = layout.itemsize;
+  for (auto extent : layout.shape) {
+    size *= extent;
+  }
+  py::object storage{py::handle<>(PyByteArray_FromStringAndSize(nullptr, size))};
+  layout.data = PyByteArray_AsString(storage.ptr());
+  layout.readonly = false;
+  return MakeMemoryView(std::move(storage), layout);
+}
+
+/// Specialize for each type that ToListOrArray can convert to a structured
+/// array, providing
+///
+///   using Row = ...; // Standard layout struct with the fields of a row.
+///   static std::string GetFormat();
+///   static Row MakeRow(const T &item);
+template <typename T>
+struct ArrayRowTraits;
+
+/// Returns the numpy module, or None if NumPy is not installed.
+static boost::python::object GetNumPy() {
+  namespace py = boost::python;
+  // Intentionally leaked, modules must not be released after Py_Finalize.
+  static auto *numpy = new py::object([]() {
+    try {
+      return py::import("numpy");
+    } catch (const py::error_already_set &) {
+      PyErr_Clear();
+      return py::object();
+    }
+  }());
+  return *numpy;
+}
+
+/// Wraps @a buffer with numpy.asarray, without copying, if NumPy is
+/// installed. Returns @a buffer otherwise.
+static boost::python::object AsNumPyArray(boost::python::object buffer) {
+  auto numpy = GetNumPy();
+  return numpy.is_none() ? buffer : numpy.attr("asarray")(buffer);
+}
+
+/// Allocates a new C-contiguous NumPy array, or memoryview if NumPy is not
+/// installed, of items of type T with the struct-module @a format. On
+/// return, @a data points to its uninitialized memory.
+template <typename T>
+static boost::python::object MakeNumPyArray(const char *format, std::vector<Py_ssize_t> shape, T *&data) {
+  BufferLayout layout;
+  layout.format = format;
+  layout.itemsize = static_cast<Py_ssize_t>(sizeof(T));
+  layout.shape = std::move(shape);
+  auto array = MakeArray(layout);
+  data = static_cast<T *>(layout.data);
+  return AsNumPyArray(array);
+}
+
+/// Converts @a items to a NumPy structured array with one row per item, as
+/// described by ArrayRowTraits. Returns a list of the items instead if
+/// @a as_array is false or NumPy is not installed.
+template <typename ContainerT>
+static boost::python::object ToListOrArray(const ContainerT &items, bool as_array) {
+  namespace py = boost::python;
+  using T = std::decay_t<decltype(*std::begin(items))>;
+  using Traits = ArrayRowTraits<T>;
+  using Row = typename Traits::Row;
+  auto numpy = as_array ? GetNumPy() : py::object();
+  if (numpy.is_none()) {
+    py::list result;
+    for (auto &&item : items) {
+      result.append(item);
+    }
+    return py::object(result);
+  }
+  static const std::string format = Traits::GetFormat();
+  BufferLayout layout;
+  layout.format = format;
+  layout.itemsize = static_cast<Py_ssize_t>(sizeof(Row));
+  layout.shape = {static_cast<Py_ssize_t>(std::distance(std::begin(items), std::end(items)))};
+  auto array = MakeArray(layout);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    auto *data = static_cast<Row *>(layout.data);
+    for (auto &&item : items) {
+      *data++ = Traits::MakeRow(item);
+    }
+  }
+  return numpy.attr("asarray")(array);
+}
+
+void export_buffer() {
+  using namespace boost::python;
+
+  class_<ArrayBuffer>("ArrayBuffer", no_init)
+    .def(BufferProtocol())
+    .def("__len__", +[](const ArrayBuffer &self) {
+      const auto &shape = self.GetLayout().shape;
+      return shape.empty() ? Py_ssize_t(0) : shape.front();
+    })
+  ;
+}
@@ -9,12 +9,16 @@
 #include "carla/client/World.h"
 #include "carla/Logging.h"
 #include "carla/rpc/ActorId.h"
+#include "carla/rpc/CommandResponse.h"
 #include "carla/trafficmanager/TrafficManager.h"
 
-#include <thread>
-
 #include <boost/python/stl_iterator.hpp>
 
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
 namespace ctm = carla::traffic_manager;
 
 static void SetTimeout(carla::client::Client &client, double seconds) {
@@ -53,125 +57,172 @@ static void ApplyBatchCommands(
   self.ApplyBatch(std::move(cmds), do_tick);
 }
 
-static auto ApplyBatchCommandsSync(
-    const carla::client::Client &self,
-    const boost::python::object &commands,
-    bool do_tick) {
-
-  using CommandType = carla::rpc::Command;
-  std::vector<CommandType> cmds {
-    boost::python::stl_input_iterator<CommandType>(commands),
-    boost::python::stl_input_iterator<CommandType>()
-  };
-
-  boost::python::list result;
-  auto responses = self.ApplyBatchSync(cmds, do_tick);
-  for (auto &response : responses) {
-    result.append(std::move(response));
-  }
-
-  // check for autopilot command
-  std::vector<carla::traffic_manager::ActorPtr> vehicles_to_enable(cmds.size(), nullptr);
-  std::vector<carla::traffic_manager::ActorPtr> vehicles_to_disable(cmds.size(), nullptr);
-  carla::client::World world = self.GetWorld();
-  uint16_t tm_port = 8000;
-
-  std::atomic<size_t> vehicles_to_enable_index;
-  std::atomic<size_t> vehicles_to_disable_index;
-
-  vehicles_to_enable_index.store(0);
-  vehicles_to_disable_index.store(0);
-
-  auto ProcessCommand = [&](size_t min_index, size_t max_index) {
-    for (size_t i = min_index; i < max_index; ++i) {
-      if (!responses[i].HasError()) {
-
-        bool isAutopilot = false;
-        bool autopilotValue = false;
-
-        CommandType::CommandType& cmd_type = cmds[i].command;
-
-        // check SpawnActor command
-        if (const auto *maybe_spawn_actor_cmd = boost::variant2::get_if<carla::rpc::Command::SpawnActor>(&cmd_type)) {
-          // check inside 'do_after'
-          for (auto &cmd : maybe_spawn_actor_cmd->do_after) {
-            if (const auto *maybe_set_autopilot_command = boost::variant2::get_if<carla::rpc::Command::SetAutopilot>(&cmd.command)) {
-              tm_port = maybe_set_autopilot_command->tm_port;
-              autopilotValue = maybe_set_autopilot_command->enabled;
-              isAutopilot = true;
-            }
-          }
-        }
-        // check SetAutopilot command
-        else if (const auto *maybe_set_autopilot_command = boost::variant2::get_if<carla::rpc::Command::SetAutopilot>(&cmd_type)) {
-          tm_port = maybe_set_autopilot_command->tm_port;
-          autopilotValue = maybe_set_autopilot_command->enabled;
-          isAutopilot = true;
-        }
-
-        // check if found any SetAutopilot command
-        if (isAutopilot) {
-          // get the id
-          carla::rpc::ActorId id = static_cast<carla::rpc::ActorId>(responses[i].Get());
-
-          // get all actors
-          carla::SharedPtr<carla::client::Actor> actor;
-          actor = world.GetActor(id);
-
-          // check to enable or disable
-          if (actor) {
-            if (autopilotValue) {
-              size_t index = vehicles_to_enable_index.fetch_add(1);
-              vehicles_to_enable[index] = actor;
-            } else {
-              size_t index = vehicles_to_disable_index.fetch_add(1);
-              vehicles_to_disable[index] = actor;
-            }
-          }
+/// Autopilot change requested by a successful command of a batch.
+struct AutopilotRequest {
+  carla::rpc::ActorId id;
+  uint16_t tm_port;
+  bool enabled;
+};
+
+/// Finds the SetAutopilot commands of a batch, alone or in the do_after of
+/// a SpawnActor, whose command succeeded. If a SpawnActor carries several,
+/// the last one wins.
+static std::vector<AutopilotRequest> GetAutopilotRequests(
+    const std::vector<carla::rpc::Command> &cmds,
+    const std::vector<carla::rpc::CommandResponse> &responses) {
+  using Command = carla::rpc::Command;
+  std::vector<AutopilotRequest> result;
+  for (size_t i = 0u; i < cmds.size(); ++i) {
+    if (responses[i].HasError()) {
+      continue;
+    }
+    const Command::SetAutopilot *autopilot = nullptr;
+    const auto &cmd_type = cmds[i].command;
+    if (const auto *spawn_actor = boost::variant2::get_if<Command::SpawnActor>(&cmd_type)) {
+      for (auto &cmd : spawn_actor->do_after) {
+        if (const auto *set_autopilot = boost::variant2::get_if<Command::SetAutopilot>(&cmd.command)) {
+          autopilot = set_autopilot;
         }
       }
+    } else {
+      autopilot = boost::variant2::get_if<Command::SetAutopilot>(&cmd_type);
+    }
+    if (autopilot != nullptr) {
+      const auto id = static_cast<carla::rpc::ActorId>(responses[i].Get());
+      result.push_back({id, autopilot->tm_port, autopilot->enabled});
     }
-  };
-
-  const size_t TaskLimit = 50;
-  size_t num_commands = cmds.size();
-  size_t num_batches = num_commands / TaskLimit;
-
-  std::vector<std::thread*> t(num_batches+1);
-
-  for(size_t n = 0; n < num_batches; n++) {
-    t[n] = new std::thread(ProcessCommand, n * TaskLimit, (n+1) * TaskLimit);
   }
-  t[num_batches] = new std::thread(ProcessCommand, num_batches * TaskLimit, num_commands);
+  return result;
+}
 
-  for(size_t n = 0; n <= num_batches; n++) {
-    if(t[n]->joinable()){
-      t[n]->join();
+/// Registers to, or unregisters from, the Traffic Manager the vehicles of
+/// the autopilot requests. The actors are resolved with a single lookup,
+/// and each Traffic Manager receives the vehicles of its own port sorted by
+/// id, so it always gets the same vectors for the same batch.
+static void ApplyAutopilotRequests(
+    const carla::client::Client &self,
+    const std::vector<AutopilotRequest> &requests) {
+  if (requests.empty()) {
+    return;
+  }
+  std::vector<carla::ActorId> ids;
+  ids.reserve(requests.size());
+  for (auto &request : requests) {
+    ids.emplace_back(request.id);
+  }
+  const auto actor_list = self.GetWorld().GetActors(ids);
+  std::unordered_map<carla::ActorId, ctm::ActorPtr> actors;
+  for (auto actor : *actor_list) {
+    actors.emplace(actor->GetId(), actor);
+  }
+  struct PortVehicles {
+    std::vector<ctm::ActorPtr> enable;
+    std::vector<ctm::ActorPtr> disable;
+  };
+  std::map<uint16_t, PortVehicles> ports;
+  for (auto &request : requests) {
+    auto it = actors.find(request.id);
+    if (it != actors.end()) {
+      auto &vehicles = ports[request.tm_port];
+      (request.enabled ? vehicles.enable : vehicles.disable).emplace_back(it->second);
+    }
+  }
+  auto by_id = [](const ctm::ActorPtr &a, const ctm::ActorPtr &b) { return a->GetId() < b->GetId(); };
+  for (auto &port : ports) {
+    auto &vehicles = port.second;
+    std::sort(vehicles.enable.begin(), vehicles.enable.end(), by_id);
+    std::sort(vehicles.disable.begin(), vehicles.disable.end(), by_id);
+    auto tm = self.GetInstanceTM(port.first);
+    if (!vehicles.enable.empty()) {
+      tm.RegisterVehicles(vehicles.enable);
+    }
+    if (!vehicles.disable.empty()) {
+      tm.UnregisterVehicles(vehicles.disable);
     }
-    delete t[n];
   }
+}
+
+/// Sends a copy of the commands in @a batch, which can be cleared and
+/// refilled for the next tick without reallocating.
+static void ApplyCommandBatch(
+    const carla::client::Client &self,
+    const CommandBatch &batch,
+    bool do_tick) {
+  auto cmds = batch.GetCommands();
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.ApplyBatch(std::move(cmds), do_tick);
+}
 
-  // Fix vector size
-  vehicles_to_enable.resize(vehicles_to_enable_index.load());
-  vehicles_to_disable.resize(vehicles_to_disable_index.load());
-  // Release memory
-  vehicles_to_enable.shrink_to_fit();
-  vehicles_to_disable.shrink_to_fit();
+static boost::python::list ApplyCommandsSync(
+    const carla::client::Client &self,
+    const std::vector<carla::rpc::Command> &cmds,
+    bool do_tick) {
+  std::vector<carla::rpc::CommandResponse> responses;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    responses = self.ApplyBatchSync(cmds, do_tick);
+    ApplyAutopilotRequests(self, GetAutopilotRequests(cmds, responses));
+  }
+  return ResponsesToList(std::move(responses));
+}
 
-  // Ensure the TM always receives the same vector by sorting the elements
-  std::vector<carla::traffic_manager::ActorPtr> sorted_vehicle_to_enable = vehicles_to_enable;
-  std::sort(sorted_vehicle_to_enable.begin(), sorted_vehicle_to_enable.end(), [](carla::traffic_manager::ActorPtr &a, carla::traffic_manager::ActorPtr &b) {return a->GetId() < b->GetId(); });
+static boost::python::list ApplyBatchCommandsSync(
+    const carla::client::Client &self,
+    const boost::python::object &commands,
+    bool do_tick) {
+  using CommandType = carla::rpc::Command;
+  const std::vector<CommandType> cmds {
+    boost::python::stl_input_iterator<CommandType>(commands),
+    boost::python::stl_input_iterator<CommandType>()
+  };
+  return ApplyCommandsSync(self, cmds, do_tick);
+}
 
-  std::vector<carla::traffic_manager::ActorPtr> sorted_vehicle_to_disable = vehicles_to_disable;
-  std::sort(sorted_vehicle_to_disable.begin(), sorted_vehicle_to_disable.end(), [](carla::traffic_manager::ActorPtr &a, carla::traffic_manager::ActorPtr &b) {return a->GetId() < b->GetId(); });
+static boost::python::list ApplyCommandBatchSync(
+    const carla::client::Client &self,
+    const CommandBatch &batch,
+    bool do_tick) {
+  // Copied while holding the GIL, other threads may refill the batch.
+  const auto cmds = batch.GetCommands();
+  return ApplyCommandsSync(self, cmds, do_tick);
+}
 
-  // check if any autopilot command was sent
-  if (sorted_vehicle_to_enable.size() || sorted_vehicle_to_disable.size()) {
-    self.GetInstanceTM(tm_port).RegisterVehicles(sorted_vehicle_to_enable);
-    self.GetInstanceTM(tm_port).UnregisterVehicles(sorted_vehicle_to_disable);
+/// Queues @a cmds on the CommandQueue, the returned future holds the
+/// responses once the batch has been applied.
+static boost::python::object SubmitCommands(
+    const carla::client::Client &self,
+    std::vector<carla::rpc::Command> cmds,
+    bool do_tick) {
+  auto task = [self, cmds = std::move(cmds), do_tick]() {
+    auto responses = self.ApplyBatchSync(cmds, do_tick);
+    ApplyAutopilotRequests(self, GetAutopilotRequests(cmds, responses));
+    return responses;
+  };
+  CommandQueue::FuturePtr future;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    future = CommandQueue::Get().Submit(std::move(task));
   }
+  return boost::python::object(future);
+}
 
-  return result;
+static boost::python::object ApplyBatchCommandsAsync(
+    const carla::client::Client &self,
+    const boost::python::object &commands,
+    bool do_tick) {
+  using CommandType = carla::rpc::Command;
+  std::vector<CommandType> cmds {
+    boost::python::stl_input_iterator<CommandType>(commands),
+    boost::python::stl_input_iterator<CommandType>()
+  };
+  return SubmitCommands(self, std::move(cmds), do_tick);
+}
+
+static boost::python::object ApplyCommandBatchAsync(
+    const carla::client::Client &self,
+    const CommandBatch &batch,
+    bool do_tick) {
+  return SubmitCommands(self, batch.GetCommands(), do_tick);
 }
 
 void export_client() {
@@ -217,7 +268,11 @@ void export_client() {
     .def("set_replayer_ignore_hero", &cc::Client::SetReplayerIgnoreHero, (arg("ignore_hero")))
     .def("set_replayer_ignore_spectator", &cc::Client::SetReplayerIgnoreSpectator, (arg("ignore_spectator")))
     .def("apply_batch", &ApplyBatchCommands, (arg("commands"), arg("do_tick")=false))
+    .def("apply_batch", &ApplyCommandBatch, (arg("commands"), arg("do_tick")=false))
     .def("apply_batch_sync", &ApplyBatchCommandsSync, (arg("commands"), arg("do_tick")=false))
+    .def("apply_batch_sync", &ApplyCommandBatchSync, (arg("commands"), arg("do_tick")=false))
+    .def("apply_batch_async", &ApplyBatchCommandsAsync, (arg("commands"), arg("do_tick")=false))
+    .def("apply_batch_async", &ApplyCommandBatchAsync, (arg("commands"), arg("do_tick")=false))
     .def("get_trafficmanager", CONST_CALL_WITHOUT_GIL_1(cc::Client, GetInstanceTM, uint16_t), (arg("port")=ctm::TM_DEFAULT_PORT))
   ;
 }
@@ -0,0 +1,239 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/rpc/ActorId.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/VehicleControl.h>
+
+#include <boost/python/stl_iterator.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// List of commands built in C++ and sent with Client.apply_batch. Clearing
+/// it keeps the allocated storage, so the same batch can be refilled every
+/// tick without reallocating.
+class CommandBatch {
+public:
+
+  using Command = carla::rpc::Command;
+
+  const std::vector<Command> &GetCommands() const {
+    return _commands;
+  }
+
+  size_t size() const {
+    return _commands.size();
+  }
+
+  void Add(Command command) {
+    _commands.emplace_back(std::move(command));
+  }
+
+  void Clear() {
+    _commands.clear();
+  }
+
+private:
+
+  std::vector<Command> _commands;
+};
+
+namespace command_batch_impl {
+
+  template <typename T, typename S>
+  static void CopyColumn(const void *src, std::vector<T> &dst) {
+    const auto *data = static_cast<const S *>(src);
+    for (size_t i = 0u; i < dst.size(); ++i) {
+      dst[i] = static_cast<T>(data[i]);
+    }
+  }
+
+  /// Converts the items of a numeric array to T, in C order. Strided views
+  /// such as column slices are copied to contiguous memory first.
+  template <typename T>
+  static void CopyBuffer(const ScopedBuffer &buffer, std::vector<T> &dst) {
+    const auto &view = buffer.view();
+    const char *format = view.format != nullptr ? view.format : "B";
+    if ((*format == '@') || (*format == '=') || (*format == '<')) {
+      ++format;
+    }
+    const auto itemsize = static_cast<size_t>(view.itemsize);
+    const void *src = buffer.data();
+    std::vector<char> contiguous;
+    if (!PyBuffer_IsContiguous(&view, 'C')) {
+      contiguous.resize(buffer.size());
+      if (PyBuffer_ToContiguous(contiguous.data(), &view, view.len, 'C') != 0) {
+        boost::python::throw_error_already_set();
+      }
+      src = contiguous.data();
+    }
+    if ((std::strlen(format) == 1u) && (buffer.size() == itemsize * dst.size())) {
+      switch (*format) {
+        case '?': if (itemsize == sizeof(bool))     return CopyColumn<T, bool>(src, dst); break;
+        case 'b': if (itemsize == sizeof(int8_t))   return CopyColumn<T, int8_t>(src, dst); break;
+        case 'B': if (itemsize == sizeof(uint8_t))  return CopyColumn<T, uint8_t>(src, dst); break;
+        case 'h': if (itemsize == sizeof(int16_t))  return CopyColumn<T, int16_t>(src, dst); break;
+        case 'H': if (itemsize == sizeof(uint16_t)) return CopyColumn<T, uint16_t>(src, dst); break;
+        case 'i':
+        case 'l':
+        case 'q':
+          if (itemsize == sizeof(int32_t)) return CopyColumn<T, int32_t>(src, dst);
+          if (itemsize == sizeof(int64_t)) return CopyColumn<T, int64_t>(src, dst);
+          break;
+        case 'I':
+        case 'L':
+        case 'Q':
+          if (itemsize == sizeof(uint32_t)) return CopyColumn<T, uint32_t>(src, dst);
+          if (itemsize == sizeof(uint64_t)) return CopyColumn<T, uint64_t>(src, dst);
+          break;
+        case 'f': if (itemsize == sizeof(float))    return CopyColumn<T, float>(src, dst); break;
+        case 'd': if (itemsize == sizeof(double))   return CopyColumn<T, double>(src, dst); break;
+        default: break;
+      }
+    }
+    throw std::invalid_argument(
+        "expected a numeric array of " + std::to_string(dst.size()) + " items");
+  }
+
+  /// Reads @a count values from None (every value is @a default_value), a
+  /// scalar, a numeric array or a sequence. Arrays are read
+  /// flattened, so an N x 3 array is a column of 3N values.
+  template <typename T>
+  static std::vector<T> ReadColumn(
+      const boost::python::object &column,
+      size_t count,
+      T default_value = T{}) {
+    namespace py = boost::python;
+    if (column.is_none()) {
+      return std::vector<T>(count, default_value);
+    }
+    std::vector<T> result(count);
+    if (PyObject_CheckBuffer(column.ptr())) {
+      ScopedBuffer buffer(column, PyBUF_STRIDES | PyBUF_FORMAT);
+      if (buffer.view().ndim == 0) {
+        // NumPy scalars export a zero-dimensional buffer, broadcast them too.
+        std::vector<T> value(1u);
+        CopyBuffer(buffer, value);
+        std::fill(result.begin(), result.end(), value[0u]);
+      } else {
+        CopyBuffer(buffer, result);
+      }
+      return result;
+    }
+    if (PyFloat_Check(column.ptr()) || PyLong_Check(column.ptr())) {
+      std::fill(result.begin(), result.end(), py::extract<T>(column)());
+      return result;
+    }
+    if (py::len(column) != static_cast<Py_ssize_t>(count)) {
+      throw std::invalid_argument(
+          "expected a sequence of " + std::to_string(count) + " items");
+    }
+    std::copy(py::stl_input_iterator<T>(column), py::stl_input_iterator<T>(), result.begin());
+    return result;
+  }
+
+  static std::vector<carla::rpc::ActorId> ReadActorIds(const boost::python::object &actor_ids) {
+    namespace py = boost::python;
+    if (PyObject_CheckBuffer(actor_ids.ptr())) {
+      ScopedBuffer buffer(actor_ids, PyBUF_STRIDES | PyBUF_FORMAT);
+      const auto itemsize = static_cast<size_t>(buffer.view().itemsize);
+      std::vector<carla::rpc::ActorId> result(itemsize > 0u ? buffer.size() / itemsize : 0u);
+      CopyBuffer(buffer, result);
+      return result;
+    }
+    return {py::stl_input_iterator<carla::rpc::ActorId>(actor_ids),
+            py::stl_input_iterator<carla::rpc::ActorId>()};
+  }
+
+  /// Reads either an N x @a Width numeric array or a sequence of N objects
+  /// of type T, converted with @a make from their Width components.
+  template <typename T, size_t Width, typename F>
+  static std::vector<T> ReadRows(const boost::python::object &rows, size_t count, F make) {
+    namespace py = boost::python;
+    if (!PyObject_CheckBuffer(rows.ptr())) {
+      if (py::len(rows) != static_cast<Py_ssize_t>(count)) {
+        throw std::invalid_argument(
+            "expected a sequence of " + std::to_string(count) + " items");
+      }
+      return {py::stl_input_iterator<T>(rows), py::stl_input_iterator<T>()};
+    }
+    const auto values = ReadColumn<float>(rows, Width * count);
+    std::vector<T> result;
+    result.reserve(count);
+    for (size_t i = 0u; i < count; ++i) {
+      result.emplace_back(make(&values[Width * i]));
+    }
+    return result;
+  }
+
+  static void ApplyVehicleControl(
+      CommandBatch &self,
+      const boost::python::object &actor_ids,
+      const boost::python::object &throttle,
+      const boost::python::object &steer,
+      const boost::python::object &brake,
+      const boost::python::object &hand_brake,
+      const boost::python::object &reverse) {
+    const auto ids = ReadActorIds(actor_ids);
+    const auto throttles = ReadColumn<float>(throttle, ids.size());
+    const auto steers = ReadColumn<float>(steer, ids.size());
+    const auto brakes = ReadColumn<float>(brake, ids.size());
+    const auto hand_brakes = ReadColumn<bool>(hand_brake, ids.size());
+    const auto reverses = ReadColumn<bool>(reverse, ids.size());
+    for (size_t i = 0u; i < ids.size(); ++i) {
+      carla::rpc::VehicleControl control;
+      control.throttle = throttles[i];
+      control.steer = steers[i];
+      control.brake = brakes[i];
+      control.hand_brake = hand_brakes[i];
+      control.reverse = reverses[i];
+      self.Add(carla::rpc::Command::ApplyVehicleControl{ids[i], control});
+    }
+  }
+
+  /// @a transforms is a sequence of carla.Transform or an N x 6 array of
+  /// (x, y, z, pitch, yaw, roll) rows.
+  static void ApplyTransform(
+      CommandBatch &self,
+      const boost::python::object &actor_ids,
+      const boost::python::object &transforms) {
+    namespace cg = carla::geom;
+    const auto ids = ReadActorIds(actor_ids);
+    const auto values = ReadRows<cg::Transform, 6u>(transforms, ids.size(), [](const float *row) {
+      return cg::Transform{cg::Location{row[0u], row[1u], row[2u]}, cg::Rotation{row[3u], row[4u], row[5u]}};
+    });
+    for (size_t i = 0u; i < ids.size(); ++i) {
+      self.Add(carla::rpc::Command::ApplyTransform{ids[i], values[i]});
+    }
+  }
+
+  /// @a velocities is a sequence of carla.Vector3D or an N x 3 array.
+  static void ApplyTargetVelocity(
+      CommandBatch &self,
+      const boost::python::object &actor_ids,
+      const boost::python::object &velocities) {
+    namespace cg = carla::geom;
+    const auto ids = ReadActorIds(actor_ids);
+    const auto values = ReadRows<cg::Vector3D, 3u>(velocities, ids.size(), [](const float *row) {
+      return cg::Vector3D{row[0u], row[1u], row[2u]};
+    });
+    for (size_t i = 0u; i < ids.size(); ++i) {
+      self.Add(carla::rpc::Command::ApplyTargetVelocity{ids[i], values[i]});
+    }
+  }
+
+  static void DestroyActor(CommandBatch &self, const boost::python::object &actor_ids) {
+    for (auto id : ReadActorIds(actor_ids)) {
+      self.Add(carla::rpc::Command::DestroyActor{id});
+    }
+  }
+
+} // namespace command_batch_impl
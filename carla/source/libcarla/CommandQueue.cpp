@@ -0,0 +1,173 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/rpc/CommandResponse.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/// Handle to the responses of a batch applied with Client.apply_batch_async.
+class BatchFuture : private boost::noncopyable {
+public:
+
+  using Responses = std::vector<carla::rpc::CommandResponse>;
+
+  bool IsDone() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _done;
+  }
+
+  /// Waits until the batch is applied, with no limit if @a seconds is zero.
+  /// Returns false on timeout.
+  bool Wait(double seconds) const {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto finished = [this]() { return _done; };
+    if (seconds <= 0.0) {
+      _condition.wait(lock, finished);
+      return true;
+    }
+    return _condition.wait_for(lock, std::chrono::duration<double>(seconds), finished);
+  }
+
+  /// Waits for the batch and returns its responses. Rethrows the exception
+  /// thrown while applying the batch, if any.
+  Responses GetResult(double seconds) const {
+    if (!Wait(seconds)) {
+      throw std::runtime_error("timeout waiting for command batch");
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_error) {
+      std::rethrow_exception(_error);
+    }
+    return _responses;
+  }
+
+  void Finish(Responses responses, std::exception_ptr error) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _done = true;
+      _responses = std::move(responses);
+      _error = std::move(error);
+    }
+    _condition.notify_all();
+  }
+
+private:
+
+  mutable std::mutex _mutex;
+
+  mutable std::condition_variable _condition;
+
+  bool _done = false;
+
+  Responses _responses;
+
+  std::exception_ptr _error;
+};
+
+/// Process-wide queue of command batches applied by a dedicated thread in
+/// submission order.
+///
+/// Submitting returns immediately, so the caller can prepare the next step
+/// while the simulator processes the batch, and several batches can be
+/// queued at once. The thread is started on first use and, like the
+/// WorkerPool, never joined.
+class CommandQueue : private boost::noncopyable {
+public:
+
+  using FuturePtr = boost::shared_ptr<BatchFuture>;
+
+  using Task = std::function<BatchFuture::Responses()>;
+
+  static CommandQueue &Get() {
+    static auto *queue = new CommandQueue;
+    return *queue;
+  }
+
+  FuturePtr Submit(Task task) {
+    auto future = boost::make_shared<BatchFuture>();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_thread.joinable()) {
+        _thread = std::thread([this]() { Run(); });
+      }
+      _queue.push_back(Item{future, std::move(task)});
+    }
+    _work.notify_one();
+    return future;
+  }
+
+  /// Waits until every batch submitted so far has been applied.
+  void Flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this]() { return _queue.empty() && !_busy; });
+  }
+
+private:
+
+  struct Item {
+    FuturePtr future;
+    Task task;
+  };
+
+  CommandQueue() = default;
+
+  void Run() {
+    for (;;) {
+      Item item;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work.wait(lock, [this]() { return !_queue.empty(); });
+        item = std::move(_queue.front());
+        _queue.pop_front();
+        _busy = true;
+      }
+      BatchFuture::Responses responses;
+      std::exception_ptr error;
+      try {
+        responses = item.task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      item.future->Finish(std::move(responses), std::move(error));
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _busy = false;
+      }
+      _idle.notify_all();
+    }
+  }
+
+  std::mutex _mutex;
+
+  std::condition_variable _work;
+
+  std::condition_variable _idle;
+
+  std::deque<Item> _queue;
+
+  std::thread _thread;
+
+  bool _busy = false;
+};
+
+static boost::python::list ResponsesToList(BatchFuture::Responses responses) {
+  boost::python::list result;
+  for (auto &response : responses) {
+    result.append(std::move(response));
+  }
+  return result;
+}
@@ -215,6 +215,38 @@ void export_commands() {
     .def_readwrite("light_state", &cr::Command::SetVehicleLightState::light_state)
   ;
 
+  class_<BatchFuture, boost::noncopyable, boost::shared_ptr<BatchFuture>>("BatchFuture", no_init)
+    .def("done", &BatchFuture::IsDone)
+    .def("wait", +[](const BatchFuture &self, double seconds) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.Wait(seconds);
+    }, (arg("seconds")=0.0))
+    .def("result", +[](const BatchFuture &self, double seconds) {
+      BatchFuture::Responses responses;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        responses = self.GetResult(seconds);
+      }
+      return ResponsesToList(std::move(responses));
+    }, (arg("seconds")=0.0))
+  ;
+
+  class_<CommandBatch>("CommandBatch")
+    .def("__len__", &CommandBatch::size)
+    .def("append", &CommandBatch::Add, (arg("command")))
+    .def("clear", &CommandBatch::Clear)
+    .def("apply_vehicle_control", &command_batch_impl::ApplyVehicleControl, (
+        arg("actor_ids"),
+        arg("throttle")=object(),
+        arg("steer")=object(),
+        arg("brake")=object(),
+        arg("hand_brake")=object(),
+        arg("reverse")=object()))
+    .def("apply_transform", &command_batch_impl::ApplyTransform, (arg("actor_ids"), arg("transforms")))
+    .def("apply_target_velocity", &command_batch_impl::ApplyTargetVelocity, (arg("actor_ids"), arg("velocities")))
+    .def("destroy_actor", &command_batch_impl::DestroyActor, (arg("actor_ids")))
+  ;
+
   implicitly_convertible<cr::Command::SpawnActor, cr::Command>();
   implicitly_convertible<cr::Command::DestroyActor, cr::Command>();
   implicitly_convertible<cr::Command::ApplyVehicleControl, cr::Command>();
@@ -0,0 +1,383 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// What to do when a file is submitted to a full DiskWriter queue.
+enum class EDiskWriterPolicy {
+  Block,
+  DropOldest,
+  DropNewest
+};
+
+/// Handle to the result of an asynchronous write.
+class DiskWriterTicket : private boost::noncopyable {
+public:
+
+  enum class State {
+    Pending,
+    Done,
+    Failed,
+    Dropped
+  };
+
+  State GetState() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _state;
+  }
+
+  bool IsDone() const {
+    return GetState() != State::Pending;
+  }
+
+  /// Waits until the write finishes, with no limit if @a seconds is zero.
+  /// Returns false on timeout.
+  bool Wait(double seconds) const {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto finished = [this]() { return _state != State::Pending; };
+    if (seconds <= 0.0) {
+      _condition.wait(lock, finished);
+      return true;
+    }
+    return _condition.wait_for(lock, std::chrono::duration<double>(seconds), finished);
+  }
+
+  /// Waits for the write and returns the path of the file written. Throws
+  /// if the write failed or the file was dropped.
+  std::string GetResult(double seconds) const {
+    if (!Wait(seconds)) {
+      throw std::runtime_error("timeout waiting for disk write");
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    switch (_state) {
+      case State::Done:
+        return _result;
+      case State::Dropped:
+        throw std::runtime_error("file dropped from the disk writer queue: " + _result);
+      default:
+        throw std::runtime_error("failed to write file: " + _result);
+    }
+  }
+
+  void Finish(State state, std::string result) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _state = state;
+      _result = std::move(result);
+    }
+    _condition.notify_all();
+  }
+
+private:
+
+  mutable std::mutex _mutex;
+
+  mutable std::condition_variable _condition;
+
+  State _state = State::Pending;
+
+  /// Path written on success, error message or requested path otherwise.
+  std::string _result;
+};
+
+/// Counters of the DiskWriter since the module was loaded.
+struct DiskWriterStats {
+  size_t queue_depth = 0u;
+  size_t in_progress = 0u;
+  size_t written = 0u;
+  size_t dropped = 0u;
+  size_t failed = 0u;
+  uint64_t bytes_written = 0u;
+  double total_encode_time = 0.0;
+  double max_encode_time = 0.0;
+
+  double GetMeanEncodeTime() const {
+    return written > 0u ? total_encode_time / static_cast<double>(written) : 0.0;
+  }
+};
+
+/// Process-wide background writer used by save_to_disk(asynchronous=True).
+///
+/// Files are encoded and written by a small set of dedicated threads fed
+/// from a bounded queue, separate from the WorkerPool since the tasks are
+/// long and block on IO. When the queue is full, Submit blocks or drops a
+/// file depending on the configured policy.
+class DiskWriter : private boost::noncopyable {
+public:
+
+  /// Encodes and writes a file, returns the path written.
+  using Task = std::function<std::string()>;
+
+  using TicketPtr = boost::shared_ptr<DiskWriterTicket>;
+
+  /// The writer is intentionally leaked, see WorkerPool::Get.
+  static DiskWriter &Get() {
+    static auto *writer = new DiskWriter;
+    return *writer;
+  }
+
+  void Configure(size_t threads, size_t queue_size, EDiskWriterPolicy policy) {
+    if (threads == 0u || queue_size == 0u) {
+      throw std::invalid_argument("disk writer needs at least one thread and a queue of one");
+    }
+    std::vector<std::thread> retired;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _queue_size = queue_size;
+      _policy = policy;
+      if (threads != _thread_count) {
+        ++_generation;
+        retired.swap(_threads);
+        _thread_count = threads;
+        if (!retired.empty()) {
+          Start();
+        }
+      }
+    }
+    _work.notify_all();
+    _space.notify_all();
+    // Retired threads finish the task in hand before exiting.
+    for (auto &thread : retired) {
+      thread.join();
+    }
+  }
+
+  /// Queues @a task, @a path is only used to report dropped files.
+  TicketPtr Submit(std::string path, Task task) {
+    auto ticket = boost::make_shared<DiskWriterTicket>();
+    Item dropped;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      Start();
+      if (_queue.size() >= _queue_size) {
+        switch (_policy) {
+          case EDiskWriterPolicy::Block:
+            _space.wait(lock, [this]() { return _queue.size() < _queue_size; });
+            break;
+          case EDiskWriterPolicy::DropOldest:
+            dropped = std::move(_queue.front());
+            _queue.pop_front();
+            ++_stats.dropped;
+            break;
+          case EDiskWriterPolicy::DropNewest:
+            ++_stats.dropped;
+            lock.unlock();
+            ticket->Finish(DiskWriterTicket::State::Dropped, std::move(path));
+            return ticket;
+        }
+      }
+      _queue.push_back(Item{ticket, std::move(path), std::move(task)});
+    }
+    _work.notify_one();
+    if (dropped.ticket != nullptr) {
+      dropped.ticket->Finish(DiskWriterTicket::State::Dropped, std::move(dropped.path));
+    }
+    return ticket;
+  }
+
+  /// Waits until every queued file is written, with no limit if @a seconds
+  /// is zero. Returns false on timeout.
+  bool Flush(double seconds) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto idle = [this]() { return _queue.empty() && (_stats.in_progress == 0u); };
+    if (seconds <= 0.0) {
+      _idle.wait(lock, idle);
+      return true;
+    }
+    return _idle.wait_for(lock, std::chrono::duration<double>(seconds), idle);
+  }
+
+  DiskWriterStats GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto stats = _stats;
+    stats.queue_depth = _queue.size();
+    return stats;
+  }
+
+private:
+
+  struct Item {
+    TicketPtr ticket;
+    std::string path;
+    Task task;
+  };
+
+  DiskWriter() = default;
+
+  /// Must be called with the lock held.
+  void Start() {
+    while (_threads.size() < _thread_count) {
+      _threads.emplace_back([this, generation = _generation]() { Run(generation); });
+    }
+  }
+
+  void Run(size_t generation) {
+    for (;;) {
+      Item item;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work.wait(lock, [&]() { return (_generation != generation) || !_queue.empty(); });
+        if (_generation != generation) {
+          return;
+        }
+        item = std::move(_queue.front());
+        _queue.pop_front();
+        ++_stats.in_progress;
+      }
+      _space.notify_one();
+      const auto start = std::chrono::steady_clock::now();
+      std::string result;
+      bool succeeded = false;
+      try {
+        result = item.task();
+        succeeded = true;
+      } catch (const std::exception &e) {
+        result = item.path + ": " + e.what();
+      } catch (...) {
+        result = item.path;
+      }
+      const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      const uint64_t bytes = succeeded ? GetFileSize(result) : 0u;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_stats.in_progress;
+        if (succeeded) {
+          ++_stats.written;
+          _stats.bytes_written += bytes;
+          _stats.total_encode_time += elapsed;
+          _stats.max_encode_time = std::max(_stats.max_encode_time, elapsed);
+        } else {
+          ++_stats.failed;
+        }
+      }
+      item.ticket->Finish(
+          succeeded ? DiskWriterTicket::State::Done : DiskWriterTicket::State::Failed,
+          std::move(result));
+      _idle.notify_all();
+    }
+  }
+
+  static uint64_t GetFileSize(const std::string &path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    const auto size = file.tellg();
+    return size > 0 ? static_cast<uint64_t>(size) : 0u;
+  }
+
+  mutable std::mutex _mutex;
+
+  std::condition_variable _work;
+
+  std::condition_variable _space;
+
+  std::condition_variable _idle;
+
+  std::deque<Item> _queue;
+
+  std::vector<std::thread> _threads;
+
+  size_t _thread_count = 2u;
+
+  size_t _queue_size = 64u;
+
+  EDiskWriterPolicy _policy = EDiskWriterPolicy::Block;
+
+  /// Incremented to retire the current threads.
+  size_t _generation = 0u;
+
+  DiskWriterStats _stats;
+};
+
+/// Submits @a task to the DiskWriter with the GIL released.
+static boost::python::object SubmitToDiskWriter(std::string path, DiskWriter::Task task) {
+  DiskWriter::TicketPtr ticket;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    ticket = DiskWriter::Get().Submit(std::move(path), std::move(task));
+  }
+  return boost::python::object(ticket);
+}
+
+std::ostream &operator<<(std::ostream &out, const DiskWriterStats &stats) {
+  out << "DiskWriterStats(queue_depth=" << std::to_string(stats.queue_depth)
+      << ", in_progress=" << std::to_string(stats.in_progress)
+      << ", written=" << std::to_string(stats.written)
+      << ", dropped=" << std::to_string(stats.dropped)
+      << ", failed=" << std::to_string(stats.failed)
+      << ", bytes_written=" << std::to_string(stats.bytes_written) << ')';
+  return out;
+}
+
+void export_disk_writer() {
+  using namespace boost::python;
+
+  enum_<EDiskWriterPolicy>("DiskWriterPolicy")
+    .value("Block", EDiskWriterPolicy::Block)
+    .value("DropOldest", EDiskWriterPolicy::DropOldest)
+    .value("DropNewest", EDiskWriterPolicy::DropNewest)
+  ;
+
+  class_<DiskWriterTicket, boost::noncopyable, boost::shared_ptr<DiskWriterTicket>>("DiskWriterTicket", no_init)
+    .add_property("dropped", +[](const DiskWriterTicket &self) {
+      return self.GetState() == DiskWriterTicket::State::Dropped;
+    })
+    .def("done", &DiskWriterTicket::IsDone)
+    .def("wait", +[](const DiskWriterTicket &self, double seconds) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.Wait(seconds);
+    }, (arg("seconds")=0.0))
+    .def("result", +[](const DiskWriterTicket &self, double seconds) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.GetResult(seconds);
+    }, (arg("seconds")=0.0))
+  ;
+
+  class_<DiskWriterStats>("DiskWriterStats", no_init)
+    .def_readonly("queue_depth", &DiskWriterStats::queue_depth)
+    .def_readonly("in_progress", &DiskWriterStats::in_progress)
+    .def_readonly("written", &DiskWriterStats::written)
+    .def_readonly("dropped", &DiskWriterStats::dropped)
+    .def_readonly("failed", &DiskWriterStats::failed)
+    .def_readonly("bytes_written", &DiskWriterStats::bytes_written)
+    .add_property("mean_encode_time", &DiskWriterStats::GetMeanEncodeTime)
+    .def_readonly("max_encode_time", &DiskWriterStats::max_encode_time)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<DiskWriter, boost::noncopyable>("DiskWriter", no_init)
+    .def("configure", +[](size_t threads, size_t queue_size, EDiskWriterPolicy policy) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      DiskWriter::Get().Configure(threads, queue_size, policy);
+    }, (arg("threads")=2u, arg("queue_size")=64u, arg("policy")=EDiskWriterPolicy::Block))
+    .staticmethod("configure")
+    .def("flush", +[](double seconds) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return DiskWriter::Get().Flush(seconds);
+    }, (arg("seconds")=0.0))
+    .staticmethod("flush")
+    .def("get_stats", +[]() {
+      return DiskWriter::Get().GetStats();
+    })
+    .staticmethod("get_stats")
+  ;
+
+  // Do not lose queued files when the interpreter exits.
+  import("atexit").attr("register")(scope().attr("DiskWriter").attr("flush"));
+}
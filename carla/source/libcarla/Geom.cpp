@@ -13,9 +13,14 @@
 #include <carla/geom/Vector3D.h>
 
 #include <boost/python/implicit.hpp>
+#include <boost/python/stl_iterator.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <cstddef>
+#include <cstring>
 #include <ostream>
+#include <stdexcept>
+#include <vector>
 
 namespace carla {
 namespace geom {
@@ -87,6 +92,76 @@ static void TransformList(const carla::geom::Transform &self, boost::python::lis
   }
 }
 
+template <typename T>
+static void TransformBuffer(
+    const carla::geom::Transform &self,
+    const ScopedBuffer &points,
+    void *out,
+    bool inverse,
+    bool translate) {
+  const auto m = geom_kernels::MakeAffine<T>(self, inverse, translate);
+  const auto *src = static_cast<const T *>(points.data());
+  auto *dst = static_cast<T *>(out);
+  carla::PythonUtil::ReleaseGIL unlock;
+  WorkerPool::Get().ParallelFor(points.size() / (3u * sizeof(T)), 1u << 16u, [&](size_t begin, size_t end) {
+    geom_kernels::TransformPoints(m, src + 3u * begin, dst + 3u * begin, end - begin);
+  });
+}
+
+/// Element type of a buffer of float32 or float64, 'f' or 'd'.
+static char GetFloatFormat(const Py_buffer &view) {
+  const char *format = view.format != nullptr ? view.format : "B";
+  if ((*format == '@') || (*format == '=') || (*format == '<')) {
+    ++format;
+  }
+  if ((std::strcmp(format, "f") == 0) && (view.itemsize == static_cast<Py_ssize_t>(sizeof(float)))) {
+    return 'f';
+  }
+  if ((std::strcmp(format, "d") == 0) && (view.itemsize == static_cast<Py_ssize_t>(sizeof(double)))) {
+    return 'd';
+  }
+  throw std::invalid_argument("points must be an array of float32 or float64");
+}
+
+/// Transforms the N x 3 array @a points into @a out, a writable array of the
+/// same type and size that may be @a points itself, or into a new array if
+/// @a out is None.
+static boost::python::object TransformPointArray(
+    const carla::geom::Transform &self,
+    const boost::python::object &points,
+    boost::python::object out,
+    bool inverse,
+    bool translate) {
+  ScopedBuffer src(points, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT);
+  const auto &view = src.view();
+  const char format = GetFloatFormat(view);
+  if ((view.ndim < 1) || (view.shape[view.ndim - 1] != 3)) {
+    throw std::invalid_argument("points must be an array of shape (N, 3)");
+  }
+  auto apply = [&](void *dst) {
+    if (format == 'f') {
+      TransformBuffer<float>(self, src, dst, inverse, translate);
+    } else {
+      TransformBuffer<double>(self, src, dst, inverse, translate);
+    }
+  };
+  if (out.is_none()) {
+    BufferLayout layout;
+    layout.format = std::string(1u, format);
+    layout.itemsize = view.itemsize;
+    layout.shape.assign(view.shape, view.shape + view.ndim);
+    auto result = AsNumPyArray(MakeArray(layout));
+    apply(layout.data);
+    return result;
+  }
+  ScopedBuffer dst(out, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT);
+  if ((GetFloatFormat(dst.view()) != format) || (dst.size() != src.size())) {
+    throw std::invalid_argument("output array must have the same type and size as the points");
+  }
+  apply(dst.data());
+  return out;
+}
+
 static boost::python::list BuildMatrix(const std::array<float, 16> &m) {
   boost::python::list r_out;
   boost::python::list r[4];
@@ -95,12 +170,166 @@ static boost::python::list BuildMatrix(const std::array<float, 16> &m) {
   return r_out;
 }
 
-static auto GetTransformMatrix(const carla::geom::Transform &self) {
-  return BuildMatrix(self.GetMatrix());
+/// Returns @a m as a 4x4 float32 array if @a as_array is true, as nested
+/// lists otherwise.
+static boost::python::object BuildMatrix(const std::array<float, 16> &m, bool as_array) {
+  if (!as_array) {
+    return BuildMatrix(m);
+  }
+  BufferLayout layout;
+  layout.format = "f";
+  layout.itemsize = static_cast<Py_ssize_t>(sizeof(float));
+  layout.shape = {4, 4};
+  auto result = MakeArray(layout);
+  std::memcpy(layout.data, m.data(), sizeof(m));
+  return AsNumPyArray(result);
+}
+
+static auto GetTransformMatrix(const carla::geom::Transform &self, bool as_array) {
+  return BuildMatrix(self.GetMatrix(), as_array);
+}
+
+static auto GetInverseTransformMatrix(const carla::geom::Transform &self, bool as_array) {
+  return BuildMatrix(self.GetInverseMatrix(), as_array);
+}
+
+/// Extracts the sequence @a bounding_boxes, each placed with the matching
+/// item of @a transforms, or in world space if @a transforms is None.
+static std::vector<geom_kernels::OrientedBox> ExtractOrientedBoxes(
+    const boost::python::object &bounding_boxes,
+    const boost::python::object &transforms) {
+  namespace py = boost::python;
+  std::vector<carla::geom::BoundingBox> boxes{
+      py::stl_input_iterator<carla::geom::BoundingBox>(bounding_boxes),
+      py::stl_input_iterator<carla::geom::BoundingBox>()};
+  std::vector<carla::geom::Transform> frames;
+  if (!transforms.is_none()) {
+    frames.assign(
+        py::stl_input_iterator<carla::geom::Transform>(transforms),
+        py::stl_input_iterator<carla::geom::Transform>());
+    if (frames.size() != boxes.size()) {
+      throw std::invalid_argument("transforms must have one item per bounding box");
+    }
+  }
+  std::vector<geom_kernels::OrientedBox> result;
+  result.reserve(boxes.size());
+  for (size_t i = 0u; i < boxes.size(); ++i) {
+    result.emplace_back(geom_kernels::MakeOrientedBox(
+        boxes[i],
+        frames.empty() ? carla::geom::Transform() : frames[i]));
+  }
+  return result;
+}
+
+static boost::python::object GetWorldVerticesBatch(
+    const boost::python::object &bounding_boxes,
+    const boost::python::object &transforms) {
+  const auto boxes = ExtractOrientedBoxes(bounding_boxes, transforms);
+  BufferLayout layout;
+  layout.format = "f";
+  layout.itemsize = static_cast<Py_ssize_t>(sizeof(float));
+  layout.shape = {static_cast<Py_ssize_t>(boxes.size()), 8, 3};
+  auto result = AsNumPyArray(MakeArray(layout));
+  auto *data = static_cast<float *>(layout.data);
+  carla::PythonUtil::ReleaseGIL unlock;
+  for (size_t i = 0u; i < boxes.size(); ++i) {
+    geom_kernels::GetVertices(boxes[i], data + 24u * i);
+  }
+  return result;
+}
+
+template <typename T>
+static void ContainsPointBuffer(
+    const std::vector<geom_kernels::OrientedBox> &boxes,
+    const ScopedBuffer &points,
+    bool *out) {
+  std::vector<geom_kernels::BoxFrame<T>> frames;
+  frames.reserve(boxes.size());
+  for (auto &box : boxes) {
+    frames.emplace_back(geom_kernels::MakeBoxFrame<T>(box));
+  }
+  const auto *src = static_cast<const T *>(points.data());
+  const size_t count = points.size() / (3u * sizeof(T));
+  carla::PythonUtil::ReleaseGIL unlock;
+  WorkerPool::Get().ParallelFor(count, 1u << 14u, [&](size_t begin, size_t end) {
+    geom_kernels::ContainsPoints(frames, src + 3u * begin, end - begin, out + begin, count);
+  });
+}
+
+/// Tests each point of the N x 3 array @a points against each box, returns
+/// an array of bool of shape (boxes, points).
+static boost::python::object ContainsPoints(
+    const boost::python::object &points,
+    const boost::python::object &bounding_boxes,
+    const boost::python::object &transforms) {
+  const auto boxes = ExtractOrientedBoxes(bounding_boxes, transforms);
+  ScopedBuffer src(points, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT);
+  const auto &view = src.view();
+  const char format = GetFloatFormat(view);
+  if ((view.ndim != 2) || (view.shape[1] != 3)) {
+    throw std::invalid_argument("points must be an array of shape (N, 3)");
+  }
+  bool *out = nullptr;
+  auto result = MakeNumPyArray<bool>("?", {static_cast<Py_ssize_t>(boxes.size()), view.shape[0]}, out);
+  if (format == 'f') {
+    ContainsPointBuffer<float>(boxes, src, out);
+  } else {
+    ContainsPointBuffer<double>(boxes, src, out);
+  }
+  return result;
 }
 
-static auto GetInverseTransformMatrix(const carla::geom::Transform &self) {
-  return BuildMatrix(self.GetInverseMatrix());
+/// Tests every pair of boxes for overlap, returns a symmetric array of bool
+/// of shape (boxes, boxes).
+static boost::python::object GetOverlaps(
+    const boost::python::object &bounding_boxes,
+    const boost::python::object &transforms) {
+  const auto boxes = ExtractOrientedBoxes(bounding_boxes, transforms);
+  const size_t count = boxes.size();
+  bool *out = nullptr;
+  auto result = MakeNumPyArray<bool>("?", {static_cast<Py_ssize_t>(count), static_cast<Py_ssize_t>(count)}, out);
+  carla::PythonUtil::ReleaseGIL unlock;
+  // Each row writes the upper half and its mirror, no two rows write the
+  // same element.
+  WorkerPool::Get().ParallelFor(count, 16u, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      out[i * count + i] = true;
+      for (size_t j = i + 1u; j < count; ++j) {
+        const bool overlap = geom_kernels::Overlap(boxes[i], boxes[j]);
+        out[i * count + j] = overlap;
+        out[j * count + i] = overlap;
+      }
+    }
+  });
+  return result;
+}
+
+/// Reads an N x 3 array of float32 or float64, or a sequence of
+/// carla.Location.
+static std::vector<carla::geom::Location> ExtractLocations(const boost::python::object &locations) {
+  namespace py = boost::python;
+  if (!PyObject_CheckBuffer(locations.ptr())) {
+    return {py::stl_input_iterator<carla::geom::Location>(locations),
+            py::stl_input_iterator<carla::geom::Location>()};
+  }
+  ScopedBuffer buffer(locations, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT);
+  const auto &view = buffer.view();
+  const char format = GetFloatFormat(view);
+  if ((view.ndim != 2) || (view.shape[1] != 3)) {
+    throw std::invalid_argument("locations must be an array of shape (N, 3)");
+  }
+  std::vector<carla::geom::Location> result(static_cast<size_t>(view.shape[0]));
+  for (size_t i = 0u; i < result.size(); ++i) {
+    if (format == 'f') {
+      const auto *src = static_cast<const float *>(buffer.data()) + 3u * i;
+      result[i] = carla::geom::Location{src[0u], src[1u], src[2u]};
+    } else {
+      const auto *src = static_cast<const double *>(buffer.data()) + 3u * i;
+      result[i] = carla::geom::Location{
+          static_cast<float>(src[0u]), static_cast<float>(src[1u]), static_cast<float>(src[2u])};
+    }
+  }
+  return result;
 }
 
 static auto Cross(const carla::geom::Vector3D &self, const carla::geom::Vector3D &other) {
@@ -135,6 +364,80 @@ static auto GetVectorAngle(const carla::geom::Vector3D &self, const carla::geom:
   return carla::geom::Math::GetVectorAngle(self, other);
 }
 
+template <>
+struct ArrayRowTraits<carla::geom::Location> {
+  struct Row {
+    float x, y, z;
+  };
+
+  static std::string GetFormat() {
+    return StructFormat()
+        .Field(offsetof(Row, x), "f", sizeof(float), "x")
+        .Field(offsetof(Row, y), "f", sizeof(float), "y")
+        .Field(offsetof(Row, z), "f", sizeof(float), "z")
+        .Build(sizeof(Row));
+  }
+
+  static Row MakeRow(const carla::geom::Location &location) {
+    return {location.x, location.y, location.z};
+  }
+};
+
+template <>
+struct ArrayRowTraits<carla::geom::Transform> {
+  struct Row {
+    float x, y, z;
+    float pitch, yaw, roll;
+  };
+
+  static std::string GetFormat() {
+    return StructFormat()
+        .Field(offsetof(Row, x), "f", sizeof(float), "x")
+        .Field(offsetof(Row, y), "f", sizeof(float), "y")
+        .Field(offsetof(Row, z), "f", sizeof(float), "z")
+        .Field(offsetof(Row, pitch), "f", sizeof(float), "pitch")
+        .Field(offsetof(Row, yaw), "f", sizeof(float), "yaw")
+        .Field(offsetof(Row, roll), "f", sizeof(float), "roll")
+        .Build(sizeof(Row));
+  }
+
+  static Row MakeRow(const carla::geom::Transform &transform) {
+    const auto &l = transform.location;
+    const auto &r = transform.rotation;
+    return {l.x, l.y, l.z, r.pitch, r.yaw, r.roll};
+  }
+};
+
+template <>
+struct ArrayRowTraits<carla::geom::BoundingBox> {
+  struct Row {
+    float x, y, z;
+    float extent_x, extent_y, extent_z;
+    float pitch, yaw, roll;
+  };
+
+  static std::string GetFormat() {
+    return StructFormat()
+        .Field(offsetof(Row, x), "f", sizeof(float), "x")
+        .Field(offsetof(Row, y), "f", sizeof(float), "y")
+        .Field(offsetof(Row, z), "f", sizeof(float), "z")
+        .Field(offsetof(Row, extent_x), "f", sizeof(float), "extent_x")
+        .Field(offsetof(Row, extent_y), "f", sizeof(float), "extent_y")
+        .Field(offsetof(Row, extent_z), "f", sizeof(float), "extent_z")
+        .Field(offsetof(Row, pitch), "f", sizeof(float), "pitch")
+        .Field(offsetof(Row, yaw), "f", sizeof(float), "yaw")
+        .Field(offsetof(Row, roll), "f", sizeof(float), "roll")
+        .Build(sizeof(Row));
+  }
+
+  static Row MakeRow(const carla::geom::BoundingBox &box) {
+    const auto &l = box.location;
+    const auto &e = box.extent;
+    const auto &r = box.rotation;
+    return {l.x, l.y, l.z, e.x, e.y, e.z, r.pitch, r.yaw, r.roll};
+  }
+};
+
 void export_geom() {
   using namespace boost::python;
   namespace cg = carla::geom;
@@ -241,11 +544,28 @@ void export_geom() {
       self.TransformVector(vector);
       return vector;
     }, arg("in_point"))
+    .def("transform_points", +[](const cg::Transform &self, const object &points, object out) {
+      return TransformPointArray(self, points, out, false, true);
+    }, (arg("points"), arg("out")=object()))
+    .def("inverse_transform_points", +[](const cg::Transform &self, const object &points, object out) {
+      return TransformPointArray(self, points, out, true, true);
+    }, (arg("points"), arg("out")=object()))
+    .def("transform_vectors", +[](const cg::Transform &self, const object &vectors, object out) {
+      return TransformPointArray(self, vectors, out, false, false);
+    }, (arg("vectors"), arg("out")=object()))
     .def("get_forward_vector", &cg::Transform::GetForwardVector)
     .def("get_right_vector", &cg::Transform::GetRightVector)
     .def("get_up_vector", &cg::Transform::GetUpVector)
-    .def("get_matrix", &GetTransformMatrix)
-    .def("get_inverse_matrix", &GetInverseTransformMatrix)
+    .def("get_matrix", &GetTransformMatrix, (arg("as_array")=false))
+    .def("get_inverse_matrix", &GetInverseTransformMatrix, (arg("as_array")=false))
+    .def("inverse", &geom_kernels::Inverse)
+    .def("lerp", +[](const cg::Transform &self, const cg::Transform &other, double t) {
+      return geom_kernels::Lerp(self, other, t);
+    }, (arg("other"), arg("t")))
+    .def("slerp", +[](const cg::Transform &self, const cg::Transform &other, double t) {
+      return geom_kernels::Slerp(self, other, t);
+    }, (arg("other"), arg("t")))
+    .def("__mul__", &geom_kernels::Compose)
     .def("__eq__", &cg::Transform::operator==)
     .def("__ne__", &cg::Transform::operator!=)
     .def(self_ns::str(self_ns::self))
@@ -263,8 +583,14 @@ void export_geom() {
     .def_readwrite("extent", &cg::BoundingBox::extent)
     .def_readwrite("rotation", &cg::BoundingBox::rotation)
     .def("contains", &cg::BoundingBox::Contains, arg("point"), arg("bbox_transform"))
-    .def("get_local_vertices", CALL_RETURNING_LIST(cg::BoundingBox, GetLocalVertices))
-    .def("get_world_vertices", CALL_RETURNING_LIST_1(cg::BoundingBox, GetWorldVertices, const cg::Transform&), arg("bbox_transform"))
+    .def("get_local_vertices", CALL_RETURNING_ARRAY(cg::BoundingBox, GetLocalVertices), (arg("as_array")=false))
+    .def("get_world_vertices", CALL_RETURNING_ARRAY_1(cg::BoundingBox, GetWorldVertices, const cg::Transform&), (arg("bbox_transform"), arg("as_array")=false))
+    .def("get_world_vertices_batch", &GetWorldVerticesBatch, (arg("bounding_boxes"), arg("transforms")=object()))
+    .staticmethod("get_world_vertices_batch")
+    .def("contains_points", &ContainsPoints, (arg("points"), arg("bounding_boxes"), arg("transforms")=object()))
+    .staticmethod("contains_points")
+    .def("get_overlaps", &GetOverlaps, (arg("bounding_boxes"), arg("transforms")=object()))
+    .staticmethod("get_overlaps")
     .def("__eq__", &cg::BoundingBox::operator==)
     .def("__ne__", &cg::BoundingBox::operator!=)
     .def(self_ns::str(self_ns::self))
@@ -0,0 +1,720 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/geom/BoundingBox.h>
+#include <carla/geom/Location.h>
+#include <carla/geom/Math.h>
+#include <carla/geom/Transform.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/// Geometry helpers of the Transform, BoundingBox, and WorldSnapshot
+/// bindings.
+///
+/// The point kernels apply an affine transform to arrays of interleaved
+/// (x, y, z) points. Each point is computed as
+///
+///   x' = m[0] * x + m[1] * y + m[2] * z + m[3]
+///
+/// and likewise for y' and z', in the same order of operations in every code
+/// path so results do not depend on the CPU. The source and destination may
+/// be the same array.
+namespace geom_kernels {
+
+  /// Row-major 3x4 affine matrix, the last row of the 4x4 matrix is implicit.
+  template <typename T>
+  using Affine = std::array<T, 12u>;
+
+  /// Affine matrix of @a transform, or of its inverse. With @a translate
+  /// false only the rotation is applied, as for vectors.
+  template <typename T>
+  static Affine<T> MakeAffine(const carla::geom::Transform &transform, bool inverse, bool translate) {
+    const auto m = inverse ? transform.GetInverseMatrix() : transform.GetMatrix();
+    Affine<T> result;
+    for (size_t i = 0u; i < 12u; ++i) {
+      result[i] = static_cast<T>(m[i]);
+    }
+    if (!translate) {
+      result[3u] = result[7u] = result[11u] = T(0);
+    }
+    return result;
+  }
+
+  template <typename T>
+  static void TransformScalar(const Affine<T> &m, const T *src, T *dst, size_t count) {
+    for (size_t i = 0u; i < count; ++i, src += 3, dst += 3) {
+      const T x = src[0];
+      const T y = src[1];
+      const T z = src[2];
+      dst[0] = m[0] * x + m[1] * y + m[2] * z + m[3];
+      dst[1] = m[4] * x + m[5] * y + m[6] * z + m[7];
+      dst[2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+    }
+  }
+
+#ifdef LIBCARLA_SIMD_X86
+
+  /// One row of the affine matrix, @a c holds its four coefficients.
+  LIBCARLA_TARGET_AVX2
+  static inline __m256 AffineRowAVX2(const __m256 *c, __m256 x, __m256 y, __m256 z) {
+    return _mm256_add_ps(
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c[0], x), _mm256_mul_ps(c[1], y)), _mm256_mul_ps(c[2], z)),
+        c[3]);
+  }
+
+  /// Transforms 8 points per iteration. The three registers loaded hold the
+  /// points interleaved, lanes are regrouped into x, y, and z registers with
+  /// two blends and a permutation each, and back before storing.
+  LIBCARLA_TARGET_AVX2
+  static void TransformAVX2(const Affine<float> &m, const float *src, float *dst, size_t count) {
+    const __m256i x_order = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+    const __m256i y_order = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+    const __m256i y_lanes = _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2);
+    const __m256i z_order = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+    __m256 c[12];
+    for (size_t i = 0u; i < 12u; ++i) {
+      c[i] = _mm256_set1_ps(m[i]);
+    }
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u, src += 24, dst += 24) {
+      const __m256 a0 = _mm256_loadu_ps(src);
+      const __m256 a1 = _mm256_loadu_ps(src + 8);
+      const __m256 a2 = _mm256_loadu_ps(src + 16);
+      const __m256 x = _mm256_permutevar8x32_ps(
+          _mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x92), a2, 0x24), x_order);
+      const __m256 y = _mm256_permutevar8x32_ps(
+          _mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x24), a2, 0x49), y_order);
+      const __m256 z = _mm256_permutevar8x32_ps(
+          _mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x49), a2, 0x92), z_order);
+      // x_order and z_order are their own inverse.
+      const __m256 rx = _mm256_permutevar8x32_ps(AffineRowAVX2(c, x, y, z), x_order);
+      const __m256 ry = _mm256_permutevar8x32_ps(AffineRowAVX2(c + 4, x, y, z), y_lanes);
+      const __m256 rz = _mm256_permutevar8x32_ps(AffineRowAVX2(c + 8, x, y, z), z_order);
+      _mm256_storeu_ps(dst, _mm256_blend_ps(_mm256_blend_ps(rx, ry, 0x92), rz, 0x24));
+      _mm256_storeu_ps(dst + 8, _mm256_blend_ps(_mm256_blend_ps(rz, rx, 0x92), ry, 0x24));
+      _mm256_storeu_ps(dst + 16, _mm256_blend_ps(_mm256_blend_ps(ry, rx, 0x24), rz, 0x92));
+    }
+    TransformScalar(m, src, dst, count - i);
+  }
+
+#endif // LIBCARLA_SIMD_X86
+
+  static void TransformPoints(const Affine<float> &m, const float *src, float *dst, size_t count) {
+#ifdef LIBCARLA_SIMD_X86
+    if (image_kernels::HasAVX2()) {
+      TransformAVX2(m, src, dst, count);
+      return;
+    }
+#endif // LIBCARLA_SIMD_X86
+    TransformScalar(m, src, dst, count);
+  }
+
+  static void TransformPoints(const Affine<double> &m, const double *src, double *dst, size_t count) {
+    TransformScalar(m, src, dst, count);
+  }
+
+  // ===========================================================================
+  // -- Rotations --------------------------------------------------------------
+  // ===========================================================================
+
+  /// Row-major 3x3 rotation matrix, in double precision so composing and
+  /// interpolating transforms does not accumulate float rounding errors. The
+  /// convention is the same as Transform::GetMatrix.
+  using Matrix3 = std::array<double, 9u>;
+
+  /// Unit quaternion (w, x, y, z).
+  using Quaternion = std::array<double, 4u>;
+
+  static constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+
+  static Matrix3 ToMatrix(const carla::geom::Rotation &rotation) {
+    const double cy = std::cos(kDegToRad * rotation.yaw);
+    const double sy = std::sin(kDegToRad * rotation.yaw);
+    const double cr = std::cos(kDegToRad * rotation.roll);
+    const double sr = std::sin(kDegToRad * rotation.roll);
+    const double cp = std::cos(kDegToRad * rotation.pitch);
+    const double sp = std::sin(kDegToRad * rotation.pitch);
+    return {
+        cp * cy, cy * sp * sr - sy * cr, -cy * sp * cr - sy * sr,
+        cp * sy, sy * sp * sr + cy * cr, -sy * sp * cr + cy * sr,
+        sp, -cp * sr, cp * cr};
+  }
+
+  static carla::geom::Rotation ToRotation(const Matrix3 &m) {
+    const double sp = std::min(std::max(m[6u], -1.0), 1.0);
+    const double pitch = std::asin(sp);
+    double yaw;
+    double roll;
+    if (std::abs(sp) < 1.0 - 1e-9) {
+      yaw = std::atan2(m[3u], m[0u]);
+      roll = std::atan2(-m[7u], m[8u]);
+    } else {
+      // Gimbal lock, only yaw +/- roll is defined.
+      yaw = std::atan2(-m[1u], m[4u]);
+      roll = 0.0;
+    }
+    return carla::geom::Rotation(
+        static_cast<float>(pitch / kDegToRad),
+        static_cast<float>(yaw / kDegToRad),
+        static_cast<float>(roll / kDegToRad));
+  }
+
+  static Matrix3 Multiply(const Matrix3 &a, const Matrix3 &b) {
+    Matrix3 result;
+    for (size_t i = 0u; i < 3u; ++i) {
+      for (size_t j = 0u; j < 3u; ++j) {
+        result[3u * i + j] = a[3u * i] * b[j] + a[3u * i + 1u] * b[3u + j] + a[3u * i + 2u] * b[6u + j];
+      }
+    }
+    return result;
+  }
+
+  static Matrix3 Transpose(const Matrix3 &m) {
+    return {m[0u], m[3u], m[6u], m[1u], m[4u], m[7u], m[2u], m[5u], m[8u]};
+  }
+
+  static std::array<double, 3u> Apply(const Matrix3 &m, double x, double y, double z) {
+    return {
+        m[0u] * x + m[1u] * y + m[2u] * z,
+        m[3u] * x + m[4u] * y + m[5u] * z,
+        m[6u] * x + m[7u] * y + m[8u] * z};
+  }
+
+  static Quaternion ToQuaternion(const Matrix3 &m) {
+    const double trace = m[0u] + m[4u] + m[8u];
+    Quaternion q;
+    if (trace > 0.0) {
+      const double s = 2.0 * std::sqrt(trace + 1.0);
+      q = {0.25 * s, (m[7u] - m[5u]) / s, (m[2u] - m[6u]) / s, (m[3u] - m[1u]) / s};
+    } else if ((m[0u] > m[4u]) && (m[0u] > m[8u])) {
+      const double s = 2.0 * std::sqrt(1.0 + m[0u] - m[4u] - m[8u]);
+      q = {(m[7u] - m[5u]) / s, 0.25 * s, (m[1u] + m[3u]) / s, (m[2u] + m[6u]) / s};
+    } else if (m[4u] > m[8u]) {
+      const double s = 2.0 * std::sqrt(1.0 + m[4u] - m[0u] - m[8u]);
+      q = {(m[2u] - m[6u]) / s, (m[1u] + m[3u]) / s, 0.25 * s, (m[5u] + m[7u]) / s};
+    } else {
+      const double s = 2.0 * std::sqrt(1.0 + m[8u] - m[0u] - m[4u]);
+      q = {(m[3u] - m[1u]) / s, (m[2u] + m[6u]) / s, (m[5u] + m[7u]) / s, 0.25 * s};
+    }
+    return q;
+  }
+
+  static Matrix3 ToMatrix(const Quaternion &q) {
+    const double w = q[0u], x = q[1u], y = q[2u], z = q[3u];
+    return {
+        1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y - w * z), 2.0 * (x * z + w * y),
+        2.0 * (x * y + w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z - w * x),
+        2.0 * (x * z - w * y), 2.0 * (y * z + w * x), 1.0 - 2.0 * (x * x + y * y)};
+  }
+
+  /// Spherical interpolation along the shortest arc.
+  static Quaternion Slerp(const Quaternion &a, Quaternion b, double t) {
+    double cos_angle = a[0u] * b[0u] + a[1u] * b[1u] + a[2u] * b[2u] + a[3u] * b[3u];
+    if (cos_angle < 0.0) {
+      cos_angle = -cos_angle;
+      for (auto &value : b) {
+        value = -value;
+      }
+    }
+    double wa = 1.0 - t;
+    double wb = t;
+    // Nearly parallel quaternions, fall back to a normalized lerp.
+    if (cos_angle < 1.0 - 1e-6) {
+      const double angle = std::acos(cos_angle);
+      const double sin_angle = std::sin(angle);
+      wa = std::sin(wa * angle) / sin_angle;
+      wb = std::sin(wb * angle) / sin_angle;
+    }
+    Quaternion result;
+    double norm = 0.0;
+    for (size_t i = 0u; i < 4u; ++i) {
+      result[i] = wa * a[i] + wb * b[i];
+      norm += result[i] * result[i];
+    }
+    norm = std::sqrt(norm);
+    for (auto &value : result) {
+      value /= norm;
+    }
+    return result;
+  }
+
+  // ===========================================================================
+  // -- Transforms -------------------------------------------------------------
+  // ===========================================================================
+
+  static carla::geom::Location MakeLocation(const std::array<double, 3u> &v) {
+    return {static_cast<float>(v[0u]), static_cast<float>(v[1u]), static_cast<float>(v[2u])};
+  }
+
+  static double Lerp(double a, double b, double t) {
+    return a + t * (b - a);
+  }
+
+  static carla::geom::Location Lerp(const carla::geom::Location &a, const carla::geom::Location &b, double t) {
+    return MakeLocation({Lerp(a.x, b.x, t), Lerp(a.y, b.y, t), Lerp(a.z, b.z, t)});
+  }
+
+  /// Transform that applies @a b and then @a a.
+  static carla::geom::Transform Compose(const carla::geom::Transform &a, const carla::geom::Transform &b) {
+    const auto ra = ToMatrix(a.rotation);
+    const auto &l = b.location;
+    auto location = Apply(ra, l.x, l.y, l.z);
+    location[0u] += a.location.x;
+    location[1u] += a.location.y;
+    location[2u] += a.location.z;
+    return {MakeLocation(location), ToRotation(Multiply(ra, ToMatrix(b.rotation)))};
+  }
+
+  static carla::geom::Transform Inverse(const carla::geom::Transform &transform) {
+    const auto rt = Transpose(ToMatrix(transform.rotation));
+    const auto &l = transform.location;
+    const auto location = Apply(rt, -l.x, -l.y, -l.z);
+    return {MakeLocation(location), ToRotation(rt)};
+  }
+
+  /// Interpolates the location and each rotation angle linearly, angles
+  /// along the shortest direction.
+  static carla::geom::Transform Lerp(const carla::geom::Transform &a, const carla::geom::Transform &b, double t) {
+    auto angle = [t](float from, float to) {
+      const double delta = std::remainder(static_cast<double>(to) - from, 360.0);
+      return static_cast<float>(from + t * delta);
+    };
+    return {
+        Lerp(a.location, b.location, t),
+        carla::geom::Rotation(
+            angle(a.rotation.pitch, b.rotation.pitch),
+            angle(a.rotation.yaw, b.rotation.yaw),
+            angle(a.rotation.roll, b.rotation.roll))};
+  }
+
+  /// Interpolates the location linearly and the rotation spherically.
+  static carla::geom::Transform Slerp(const carla::geom::Transform &a, const carla::geom::Transform &b, double t) {
+    const auto q = Slerp(ToQuaternion(ToMatrix(a.rotation)), ToQuaternion(ToMatrix(b.rotation)), t);
+    return {Lerp(a.location, b.location, t), ToRotation(ToMatrix(q))};
+  }
+
+  // ===========================================================================
+  // -- Oriented boxes ---------------------------------------------------------
+  // ===========================================================================
+
+  /// Bounding box placed in world space. The rows of @a axes are the unit
+  /// vectors along the local x, y, and z of the box.
+  struct OrientedBox {
+    std::array<double, 3u> center;
+    Matrix3 axes;
+    std::array<double, 3u> extent;
+  };
+
+  /// @a box placed with @a transform, its own location and rotation are
+  /// relative to @a transform as in BoundingBox::GetWorldVertices.
+  static OrientedBox MakeOrientedBox(const carla::geom::BoundingBox &box, const carla::geom::Transform &transform) {
+    const auto rotation = ToMatrix(transform.rotation);
+    const auto center = Apply(rotation, box.location.x, box.location.y, box.location.z);
+    return {
+        {center[0u] + transform.location.x, center[1u] + transform.location.y, center[2u] + transform.location.z},
+        // The columns of the rotation matrix are the axes of the box.
+        Transpose(Multiply(rotation, ToMatrix(box.rotation))),
+        {box.extent.x, box.extent.y, box.extent.z}};
+  }
+
+  /// Writes the 8 vertices of @a box to @a dst in the order of
+  /// BoundingBox::GetLocalVertices.
+  static void GetVertices(const OrientedBox &box, float *dst) {
+    for (size_t k = 0u; k < 8u; ++k, dst += 3) {
+      const double x = (k & 4u) != 0u ? box.extent[0u] : -box.extent[0u];
+      const double y = (k & 2u) != 0u ? box.extent[1u] : -box.extent[1u];
+      const double z = (k & 1u) != 0u ? box.extent[2u] : -box.extent[2u];
+      for (size_t j = 0u; j < 3u; ++j) {
+        dst[j] = static_cast<float>(
+            box.center[j] + x * box.axes[j] + y * box.axes[3u + j] + z * box.axes[6u + j]);
+      }
+    }
+  }
+
+  /// Oriented box converted to the precision of the points tested against
+  /// it. A point p is inside if |dot(p - center, axis_i)| <= extent_i for
+  /// each axis, boundary included as in BoundingBox::Contains. Unlike
+  /// BoundingBox::Contains, the axes include the rotation of the box.
+  template <typename T>
+  struct BoxFrame {
+    std::array<T, 3u> center;
+    std::array<T, 9u> axes;
+    std::array<T, 3u> extent;
+  };
+
+  template <typename T>
+  static BoxFrame<T> MakeBoxFrame(const OrientedBox &box) {
+    BoxFrame<T> result;
+    for (size_t i = 0u; i < 3u; ++i) {
+      result.center[i] = static_cast<T>(box.center[i]);
+      result.extent[i] = static_cast<T>(box.extent[i]);
+    }
+    for (size_t i = 0u; i < 9u; ++i) {
+      result.axes[i] = static_cast<T>(box.axes[i]);
+    }
+    return result;
+  }
+
+  /// Tests the points given as separate x, y, and z arrays.
+  template <typename T>
+  static void ContainsScalar(const BoxFrame<T> &box, const T *x, const T *y, const T *z, size_t count, bool *out) {
+    const auto &a = box.axes;
+    for (size_t i = 0u; i < count; ++i) {
+      const T dx = x[i] - box.center[0u];
+      const T dy = y[i] - box.center[1u];
+      const T dz = z[i] - box.center[2u];
+      const T u = a[0] * dx + a[1] * dy + a[2] * dz;
+      const T v = a[3] * dx + a[4] * dy + a[5] * dz;
+      const T w = a[6] * dx + a[7] * dy + a[8] * dz;
+      out[i] = (std::abs(u) <= box.extent[0u]) && (std::abs(v) <= box.extent[1u]) && (std::abs(w) <= box.extent[2u]);
+    }
+  }
+
+#ifdef LIBCARLA_SIMD_X86
+
+  /// Expands each 8-bit mask to 8 bools, to store the results of 8 points
+  /// at once.
+  static const std::array<uint64_t, 256u> &GetMaskBytes() {
+    static const auto table = []() {
+      std::array<uint64_t, 256u> result;
+      for (size_t mask = 0u; mask < result.size(); ++mask) {
+        bool bytes[8u];
+        for (size_t k = 0u; k < 8u; ++k) {
+          bytes[k] = ((mask >> k) & 1u) != 0u;
+        }
+        std::memcpy(&result[mask], bytes, sizeof(bytes));
+      }
+      return result;
+    }();
+    return table;
+  }
+
+  /// Tests 8 points per iteration, with the same operations as
+  /// ContainsScalar.
+  LIBCARLA_TARGET_AVX2
+  static void ContainsAVX2(const BoxFrame<float> &box, const float *x, const float *y, const float *z, size_t count, bool *out) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 cx = _mm256_set1_ps(box.center[0u]);
+    const __m256 cy = _mm256_set1_ps(box.center[1u]);
+    const __m256 cz = _mm256_set1_ps(box.center[2u]);
+    const __m256 ex = _mm256_set1_ps(box.extent[0u]);
+    const __m256 ey = _mm256_set1_ps(box.extent[1u]);
+    const __m256 ez = _mm256_set1_ps(box.extent[2u]);
+    __m256 c[12];
+    for (size_t i = 0u; i < 3u; ++i) {
+      for (size_t j = 0u; j < 3u; ++j) {
+        c[4u * i + j] = _mm256_set1_ps(box.axes[3u * i + j]);
+      }
+      c[4u * i + 3u] = _mm256_setzero_ps();
+    }
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), cx);
+      const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), cy);
+      const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + i), cz);
+      const __m256 u = _mm256_andnot_ps(sign, AffineRowAVX2(c, dx, dy, dz));
+      const __m256 v = _mm256_andnot_ps(sign, AffineRowAVX2(c + 4, dx, dy, dz));
+      const __m256 w = _mm256_andnot_ps(sign, AffineRowAVX2(c + 8, dx, dy, dz));
+      const __m256 inside = _mm256_and_ps(
+          _mm256_and_ps(_mm256_cmp_ps(u, ex, _CMP_LE_OQ), _mm256_cmp_ps(v, ey, _CMP_LE_OQ)),
+          _mm256_cmp_ps(w, ez, _CMP_LE_OQ));
+      std::memcpy(out + i, &GetMaskBytes()[static_cast<size_t>(_mm256_movemask_ps(inside))], 8u);
+    }
+    ContainsScalar(box, x + i, y + i, z + i, count - i, out + i);
+  }
+
+#endif // LIBCARLA_SIMD_X86
+
+  static void Contains(const BoxFrame<float> &box, const float *x, const float *y, const float *z, size_t count, bool *out) {
+#ifdef LIBCARLA_SIMD_X86
+    if (image_kernels::HasAVX2()) {
+      ContainsAVX2(box, x, y, z, count, out);
+      return;
+    }
+#endif // LIBCARLA_SIMD_X86
+    ContainsScalar(box, x, y, z, count, out);
+  }
+
+  static void Contains(const BoxFrame<double> &box, const double *x, const double *y, const double *z, size_t count, bool *out) {
+    ContainsScalar(box, x, y, z, count, out);
+  }
+
+  /// Tests @a count interleaved (x, y, z) points against each of @a boxes.
+  /// The result for box b is written to the row out + b * row_stride, so
+  /// ranges of points can be processed independently.
+  ///
+  /// Points are split into blocks kept in separate x, y, and z arrays while
+  /// every box is tested against the block, the deinterleaving is done once
+  /// per block rather than once per box.
+  template <typename T>
+  static void ContainsPoints(
+      const std::vector<BoxFrame<T>> &boxes,
+      const T *points,
+      size_t count,
+      bool *out,
+      size_t row_stride) {
+    constexpr size_t block = 1024u;
+    std::array<T, block> x;
+    std::array<T, block> y;
+    std::array<T, block> z;
+    for (size_t begin = 0u; begin < count; begin += block) {
+      const size_t size = std::min(block, count - begin);
+      const T *src = points + 3u * begin;
+      for (size_t i = 0u; i < size; ++i, src += 3) {
+        x[i] = src[0];
+        y[i] = src[1];
+        z[i] = src[2];
+      }
+      for (size_t b = 0u; b < boxes.size(); ++b) {
+        Contains(boxes[b], x.data(), y.data(), z.data(), size, out + b * row_stride + begin);
+      }
+    }
+  }
+
+  /// Separating axis test of two oriented boxes, following Gottschalk et
+  /// al., "OBBTree: A Hierarchical Structure for Rapid Interference
+  /// Detection". The 15 candidate axes are the face normals of each box and
+  /// the cross products of their edges. Touching boxes overlap.
+  static bool Overlap(const OrientedBox &a, const OrientedBox &b) {
+    // Bounding spheres first, most pairs are far apart.
+    const double dx = b.center[0u] - a.center[0u];
+    const double dy = b.center[1u] - a.center[1u];
+    const double dz = b.center[2u] - a.center[2u];
+    const double radii =
+        std::sqrt(a.extent[0u] * a.extent[0u] + a.extent[1u] * a.extent[1u] + a.extent[2u] * a.extent[2u]) +
+        std::sqrt(b.extent[0u] * b.extent[0u] + b.extent[1u] * b.extent[1u] + b.extent[2u] * b.extent[2u]);
+    if (dx * dx + dy * dy + dz * dz > radii * radii) {
+      return false;
+    }
+    // Rotation of b expressed in the frame of a. The epsilon keeps the
+    // cross product axes robust when edges are parallel.
+    constexpr double epsilon = 1e-9;
+    double r[3u][3u];
+    double abs_r[3u][3u];
+    for (size_t i = 0u; i < 3u; ++i) {
+      for (size_t j = 0u; j < 3u; ++j) {
+        r[i][j] =
+            a.axes[3u * i] * b.axes[3u * j] +
+            a.axes[3u * i + 1u] * b.axes[3u * j + 1u] +
+            a.axes[3u * i + 2u] * b.axes[3u * j + 2u];
+        abs_r[i][j] = std::abs(r[i][j]) + epsilon;
+      }
+    }
+    const auto t = Apply(a.axes, dx, dy, dz);
+    const auto &ea = a.extent;
+    const auto &eb = b.extent;
+    for (size_t i = 0u; i < 3u; ++i) {
+      const double rb = eb[0u] * abs_r[i][0u] + eb[1u] * abs_r[i][1u] + eb[2u] * abs_r[i][2u];
+      if (std::abs(t[i]) > ea[i] + rb) {
+        return false;
+      }
+    }
+    for (size_t j = 0u; j < 3u; ++j) {
+      const double ra = ea[0u] * abs_r[0u][j] + ea[1u] * abs_r[1u][j] + ea[2u] * abs_r[2u][j];
+      if (std::abs(t[0u] * r[0u][j] + t[1u] * r[1u][j] + t[2u] * r[2u][j]) > ra + eb[j]) {
+        return false;
+      }
+    }
+    for (size_t i = 0u; i < 3u; ++i) {
+      const size_t i1 = (i + 1u) % 3u;
+      const size_t i2 = (i + 2u) % 3u;
+      for (size_t j = 0u; j < 3u; ++j) {
+        const size_t j1 = (j + 1u) % 3u;
+        const size_t j2 = (j + 2u) % 3u;
+        const double ra = ea[i1] * abs_r[i2][j] + ea[i2] * abs_r[i1][j];
+        const double rb = eb[j1] * abs_r[i][j2] + eb[j2] * abs_r[i][j1];
+        if (std::abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra + rb) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // ===========================================================================
+  // -- KdTree -----------------------------------------------------------------
+  // ===========================================================================
+
+  /// Static k-d tree over a set of locations, each tagged with an id, for
+  /// radius and k-nearest queries.
+  ///
+  /// The tree is stored implicitly in the array of items: the node of a
+  /// range is its middle item, which splits the range along the axis of
+  /// largest spread. Ranges of a few items are scanned linearly.
+  class KdTree {
+  public:
+
+    struct Item {
+      carla::geom::Location location;
+      uint32_t id;
+    };
+
+    /// An item found by a query, with its squared distance to the query
+    /// location.
+    using Neighbor = std::pair<float, uint32_t>;
+
+    explicit KdTree(std::vector<Item> items)
+      : _items(std::move(items)),
+        _axes(_items.size(), 0u) {
+      Build(0u, _items.size());
+    }
+
+    size_t size() const {
+      return _items.size();
+    }
+
+    /// Items within @a radius of @a location that satisfy @a filter, sorted
+    /// by distance.
+    template <typename FilterT>
+    std::vector<Neighbor> QueryRadius(const carla::geom::Location &location, float radius, FilterT &&filter) const {
+      std::vector<Neighbor> result;
+      QueryRadius(0u, _items.size(), location, radius * radius, filter, result);
+      std::sort(result.begin(), result.end());
+      return result;
+    }
+
+    /// The @a k items closest to @a location that satisfy @a filter, sorted
+    /// by distance.
+    template <typename FilterT>
+    std::vector<Neighbor> QueryKnn(const carla::geom::Location &location, size_t k, FilterT &&filter) const {
+      std::priority_queue<Neighbor> heap;
+      if (k > 0u) {
+        QueryKnn(0u, _items.size(), location, k, filter, heap);
+      }
+      std::vector<Neighbor> result(heap.size());
+      for (auto i = result.size(); i > 0u; --i) {
+        result[i - 1u] = heap.top();
+        heap.pop();
+      }
+      return result;
+    }
+
+  private:
+
+    static constexpr size_t kLeafSize = 8u;
+
+    static float Get(const carla::geom::Location &location, uint8_t axis) {
+      return axis == 0u ? location.x : (axis == 1u ? location.y : location.z);
+    }
+
+    void Build(size_t begin, size_t end) {
+      if (end - begin <= kLeafSize) {
+        return;
+      }
+      carla::geom::Location min = _items[begin].location;
+      carla::geom::Location max = min;
+      for (size_t i = begin + 1u; i < end; ++i) {
+        const auto &location = _items[i].location;
+        min = {std::min(min.x, location.x), std::min(min.y, location.y), std::min(min.z, location.z)};
+        max = {std::max(max.x, location.x), std::max(max.y, location.y), std::max(max.z, location.z)};
+      }
+      const auto spread = max - min;
+      const uint8_t axis =
+          (spread.x >= spread.y) && (spread.x >= spread.z) ? 0u : (spread.y >= spread.z ? 1u : 2u);
+      const size_t middle = begin + (end - begin) / 2u;
+      std::nth_element(
+          _items.begin() + static_cast<std::ptrdiff_t>(begin),
+          _items.begin() + static_cast<std::ptrdiff_t>(middle),
+          _items.begin() + static_cast<std::ptrdiff_t>(end),
+          [axis](const Item &lhs, const Item &rhs) {
+            return Get(lhs.location, axis) < Get(rhs.location, axis);
+          });
+      _axes[middle] = axis;
+      Build(begin, middle);
+      Build(middle + 1u, end);
+    }
+
+    template <typename FilterT>
+    void QueryRadius(
+        size_t begin,
+        size_t end,
+        const carla::geom::Location &location,
+        float radius_squared,
+        FilterT &filter,
+        std::vector<Neighbor> &result) const {
+      auto visit = [&](const Item &item) {
+        const float distance = carla::geom::Math::DistanceSquared(location, item.location);
+        if ((distance <= radius_squared) && filter(item.id)) {
+          result.emplace_back(distance, item.id);
+        }
+      };
+      if (end - begin <= kLeafSize) {
+        for (size_t i = begin; i < end; ++i) {
+          visit(_items[i]);
+        }
+        return;
+      }
+      const size_t middle = begin + (end - begin) / 2u;
+      const auto &item = _items[middle];
+      visit(item);
+      const float offset = Get(location, _axes[middle]) - Get(item.location, _axes[middle]);
+      if (offset <= 0.0f || offset * offset <= radius_squared) {
+        QueryRadius(begin, middle, location, radius_squared, filter, result);
+      }
+      if (offset >= 0.0f || offset * offset <= radius_squared) {
+        QueryRadius(middle + 1u, end, location, radius_squared, filter, result);
+      }
+    }
+
+    template <typename FilterT>
+    void QueryKnn(
+        size_t begin,
+        size_t end,
+        const carla::geom::Location &location,
+        size_t k,
+        FilterT &filter,
+        std::priority_queue<Neighbor> &heap) const {
+      auto visit = [&](const Item &item) {
+        const float distance = carla::geom::Math::DistanceSquared(location, item.location);
+        if (((heap.size() < k) || (distance < heap.top().first)) && filter(item.id)) {
+          heap.emplace(distance, item.id);
+          if (heap.size() > k) {
+            heap.pop();
+          }
+        }
+      };
+      if (end - begin <= kLeafSize) {
+        for (size_t i = begin; i < end; ++i) {
+          visit(_items[i]);
+        }
+        return;
+      }
+      const size_t middle = begin + (end - begin) / 2u;
+      const auto &item = _items[middle];
+      visit(item);
+      const float offset = Get(location, _axes[middle]) - Get(item.location, _axes[middle]);
+      // Visit the side of the query first, the other side only if it may
+      // still hold a closer item.
+      const bool left_first = offset <= 0.0f;
+      if (left_first) {
+        QueryKnn(begin, middle, location, k, filter, heap);
+      } else {
+        QueryKnn(middle + 1u, end, location, k, filter, heap);
+      }
+      if ((heap.size() < k) || (offset * offset < heap.top().first)) {
+        if (left_first) {
+          QueryKnn(middle + 1u, end, location, k, filter, heap);
+        } else {
+          QueryKnn(begin, middle, location, k, filter, heap);
+        }
+      }
+    }
+
+    std::vector<Item> _items;
+
+    /// Split axis of each node, indexed by its middle item.
+    std::vector<uint8_t> _axes;
+  };
+
+} // namespace geom_kernels
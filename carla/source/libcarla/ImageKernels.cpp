@@ -0,0 +1,598 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/image/ColorConverter.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// SSE2 is only part of the baseline on x86-64, 32-bit builds use the
+// portable kernels.
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LIBCARLA_SIMD_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#endif
+
+#if defined(LIBCARLA_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#  define LIBCARLA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define LIBCARLA_TARGET_AVX2
+#endif
+
+/// Color conversion kernels for BGRA images, equivalent to applying the
+/// carla::image::ColorConverter functors pixel by pixel. Pixels are handled
+/// as 32-bit words, blue in the lowest byte.
+///
+/// The lookup tables are generated from the ColorConverter functors
+/// themselves, so every code path produces exactly the same output as
+/// ImageConverter::ConvertInPlace.
+namespace image_kernels {
+
+  using Kernel = void (*)(const uint32_t *src, uint32_t *dst, size_t count);
+
+  /// Converts @a count optical flow vectors, stored as interleaved (x, y)
+  /// float pairs, to BGRA pixels.
+  using FlowKernel = void (*)(const float *src, uint32_t *dst, size_t count);
+
+  // ===========================================================================
+  // -- CPU features -----------------------------------------------------------
+  // ===========================================================================
+
+  static bool CpuSupportsAVX2() {
+#if !defined(LIBCARLA_SIMD_X86)
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+      return false;
+    }
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+        ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+
+  static bool HasAVX2() {
+    static const bool result = CpuSupportsAVX2();
+    return result;
+  }
+
+  // ===========================================================================
+  // -- Pixel helpers ----------------------------------------------------------
+  // ===========================================================================
+
+  /// The depth cameras encode the depth in the color channels as
+  /// R + G * 256 + B * 256 * 256.
+  static inline uint32_t EncodedDepth(uint32_t pixel) {
+    return ((pixel >> 16u) & 0xffu) | (pixel & 0xff00u) | ((pixel & 0xffu) << 16u);
+  }
+
+  static inline uint32_t GrayscalePixel(uint32_t value) {
+    return value | (value << 8u) | (value << 16u) | 0xff000000u;
+  }
+
+  static inline uint32_t ToPixel(const boost::gil::bgra8_pixel_t &pixel) {
+    uint32_t result;
+    static_assert(sizeof(pixel) == sizeof(result), "unexpected pixel size");
+    std::memcpy(&result, &pixel, sizeof(result));
+    return result;
+  }
+
+  static inline boost::gil::bgra8_pixel_t FromPixel(uint32_t word) {
+    boost::gil::bgra8_pixel_t result;
+    std::memcpy(static_cast<void *>(&result), &word, sizeof(result));
+    return result;
+  }
+
+  template <typename ConverterT>
+  static uint32_t ConvertPixel(uint32_t pixel) {
+    boost::gil::bgra8_pixel_t out;
+    ConverterT{}(FromPixel(pixel), out);
+    return ToPixel(out);
+  }
+
+  // The depth converters output a float gray level, ImageView converts it to
+  // the destination pixel afterwards.
+  template <typename ConverterT>
+  static uint32_t ConvertDepthPixel(uint32_t pixel) {
+    boost::gil::gray32f_pixel_t gray;
+    ConverterT{}(FromPixel(pixel), gray);
+    boost::gil::bgra8_pixel_t out;
+    boost::gil::color_convert(gray, out);
+    return ToPixel(out);
+  }
+
+  // ===========================================================================
+  // -- Lookup tables ----------------------------------------------------------
+  // ===========================================================================
+
+  /// Converted pixel for each value of the red channel, used by the semantic
+  /// segmentation palette.
+  struct PaletteTable {
+    PaletteTable() {
+      for (uint32_t tag = 0u; tag < colors.size(); ++tag) {
+        colors[tag] = ConvertPixel<carla::image::ColorConverter::CityScapesPalette>(tag << 16u);
+      }
+    }
+
+    std::array<uint32_t, 256u> colors;
+  };
+
+  /// The grayscale output of the depth converters is a non-decreasing
+  /// function of the encoded depth, so it can be computed exactly from the
+  /// first depth that produces each gray level. This avoids evaluating the
+  /// logarithm per pixel.
+  ///
+  /// For the fast path, the depth range is split in buckets of 256 values;
+  /// when no bucket contains more than one level change, each bucket stores
+  /// its first level and the offset at which the next level starts, so the
+  /// level is found with a single lookup.
+  struct DepthLevelTable {
+    static constexpr uint32_t bucket_bits = 8u;
+    static constexpr uint32_t bucket_size = 1u << bucket_bits;
+    static constexpr uint32_t depth_end = 1u << 24u;
+
+    template <typename ConverterT>
+    static DepthLevelTable Make() {
+      auto level = [](uint32_t depth) {
+        const uint32_t pixel = ((depth & 0xffu) << 16u) | (depth & 0xff00u) | ((depth >> 16u) & 0xffu);
+        return ConvertDepthPixel<ConverterT>(pixel) & 0xffu;
+      };
+      DepthLevelTable table;
+      // Binary search of the first depth of each level, levels never reached
+      // are left at depth_end.
+      table.thresholds[0u] = 0u;
+      for (uint32_t value = 1u; value < table.thresholds.size(); ++value) {
+        uint32_t first = table.thresholds[value - 1u];
+        uint32_t last = depth_end;
+        while (first < last) {
+          const uint32_t middle = first + (last - first) / 2u;
+          if (level(middle) >= value) {
+            last = middle;
+          } else {
+            first = middle + 1u;
+          }
+        }
+        table.thresholds[value] = first;
+      }
+      table.buckets.resize(depth_end >> bucket_bits);
+      table.single_step = true;
+      // std::min takes references, a local avoids odr-using the member.
+      const uint32_t max_offset = bucket_size;
+      for (uint32_t bucket = 0u; bucket < table.buckets.size(); ++bucket) {
+        const uint32_t begin = bucket << bucket_bits;
+        const uint32_t base = table.Search(begin);
+        const uint32_t next = table.thresholds[base + 1u];
+        const uint32_t offset = std::min(next - begin, max_offset);
+        table.buckets[bucket] = base | (offset << 8u);
+        if (table.Search(begin + bucket_size - 1u) > base + 1u) {
+          table.single_step = false;
+        }
+      }
+      return table;
+    }
+
+    uint32_t Search(uint32_t depth) const {
+      uint32_t value = 0u;
+      for (uint32_t step = 128u; step > 0u; step >>= 1u) {
+        if (thresholds[value + step] <= depth) {
+          value += step;
+        }
+      }
+      return value;
+    }
+
+    uint32_t Level(uint32_t depth) const {
+      if (!single_step) {
+        return Search(depth);
+      }
+      const uint32_t entry = buckets[depth >> bucket_bits];
+      return (entry & 0xffu) + ((depth & (bucket_size - 1u)) >= (entry >> 8u) ? 1u : 0u);
+    }
+
+    /// Index 256 is a sentinel that no depth reaches.
+    std::array<uint32_t, 257u> thresholds;
+
+    std::vector<uint32_t> buckets;
+
+    bool single_step = false;
+  };
+
+  static const PaletteTable &GetPaletteTable() {
+    static const PaletteTable table;
+    return table;
+  }
+
+  static const DepthLevelTable &GetLogarithmicDepthTable() {
+    static const DepthLevelTable table =
+        DepthLevelTable::Make<carla::image::ColorConverter::LogarithmicDepth>();
+    return table;
+  }
+
+  // ===========================================================================
+  // -- Scalar kernels ---------------------------------------------------------
+  // ===========================================================================
+
+  static inline uint32_t DepthLevel(uint32_t depth) {
+    const float normalized = static_cast<float>(depth) / static_cast<float>(256 * 256 * 256 - 1);
+    return static_cast<uint32_t>(normalized * 255.0f + 0.5f);
+  }
+
+  static void DepthScalar(const uint32_t *src, uint32_t *dst, size_t count) {
+    for (size_t i = 0u; i < count; ++i) {
+      dst[i] = GrayscalePixel(DepthLevel(EncodedDepth(src[i])));
+    }
+  }
+
+  static void LogarithmicDepthScalar(const uint32_t *src, uint32_t *dst, size_t count) {
+    const auto &table = GetLogarithmicDepthTable();
+    for (size_t i = 0u; i < count; ++i) {
+      dst[i] = GrayscalePixel(table.Level(EncodedDepth(src[i])));
+    }
+  }
+
+  static void CityScapesPaletteScalar(const uint32_t *src, uint32_t *dst, size_t count) {
+    const auto &colors = GetPaletteTable().colors;
+    for (size_t i = 0u; i < count; ++i) {
+      dst[i] = colors[(src[i] >> 16u) & 0xffu];
+    }
+  }
+
+
+  // ===========================================================================
+  // -- Optical flow -----------------------------------------------------------
+  // ===========================================================================
+
+  // The optical flow is color coded in HSV, with the direction of the vector
+  // as hue and the logarithm of its length as value. The kernels use
+  // polynomial approximations of atan2 and log, accurate to about 1e-5, and
+  // compute the hue sectors without branches. The scalar and the vectorized
+  // code perform the same operations so their output is identical.
+
+  struct FlowConstants {
+    // Scale of the original implementation, which approximates pi as 3.1415.
+    static constexpr float rad2deg = 360.0f / (2.0f * 3.1415f);
+    static constexpr float shift = 0.999f;
+    static constexpr float half_pi = 1.57079637f;
+    static constexpr float pi = 3.14159274f;
+    static constexpr float sqrt2 = 1.41421354f;
+    static constexpr float ln2 = 0.693147182f;
+    static constexpr float atan_c1 = -0.0464964749f;
+    static constexpr float atan_c2 = 0.15931422f;
+    static constexpr float atan_c3 = -0.327622764f;
+
+    /// 1 / log(0.1 + shift), the value saturates for vectors of length 0.1.
+    static float IntensityScale() {
+      static const float scale = 1.0f / std::log(0.1f + shift);
+      return scale;
+    }
+  };
+
+  static inline float FastAtan2(float y, float x) {
+    using C = FlowConstants;
+    const float ax = std::abs(x);
+    const float ay = std::abs(y);
+    const float a = std::min(ax, ay) / std::max(std::max(ax, ay), std::numeric_limits<float>::min());
+    const float s = a * a;
+    float r = ((C::atan_c1 * s + C::atan_c2) * s + C::atan_c3) * s * a + a;
+    r = (ay > ax) ? (C::half_pi - r) : r;
+    r = (x < 0.0f) ? (C::pi - r) : r;
+    return (y < 0.0f) ? -r : r;
+  }
+
+  /// Natural logarithm of a positive, normal @a x.
+  static inline float FastLog(float x) {
+    using C = FlowConstants;
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float exponent = static_cast<float>(static_cast<int>(bits >> 23u) - 127);
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    // Move the mantissa to [sqrt(2)/2, sqrt(2)) to reduce the series range.
+    const bool large = m > C::sqrt2;
+    m = large ? (m * 0.5f) : m;
+    exponent = large ? (exponent + 1.0f) : exponent;
+    const float t = (m - 1.0f) / (m + 1.0f);
+    const float t2 = t * t;
+    const float series = ((t2 * (1.0f / 7.0f) + (1.0f / 5.0f)) * t2 + (1.0f / 3.0f)) * t2 + 1.0f;
+    return exponent * C::ln2 + 2.0f * t * series;
+  }
+
+  /// Channel of the HSV to RGB conversion with full saturation, @a n is 5
+  /// for red, 3 for green and 1 for blue.
+  static inline uint32_t FlowChannel(float n, float hue, float value) {
+    float k = n + hue;
+    k = (k >= 6.0f) ? (k - 6.0f) : k;
+    const float weight = std::min(std::max(std::min(k, 4.0f - k), 0.0f), 1.0f);
+    return static_cast<uint32_t>((value - value * weight) * 255.0f);
+  }
+
+  static void OpticalFlowScalar(const float *src, uint32_t *dst, size_t count) {
+    using C = FlowConstants;
+    const float scale = C::IntensityScale();
+    for (size_t i = 0u; i < count; ++i) {
+      const float x = src[2u * i];
+      const float y = src[2u * i + 1u];
+      float angle = 180.0f + FastAtan2(y, x) * C::rad2deg;
+      angle = (angle < 0.0f) ? (angle + 360.0f) : angle;
+      angle = (angle >= 360.0f) ? (angle - 360.0f) : angle;
+      const float hue = angle * (1.0f / 60.0f);
+      const float norm = std::sqrt(x * x + y * y);
+      const float value = std::min(std::max(scale * FastLog(norm + C::shift), 0.0f), 1.0f);
+      dst[i] =
+          FlowChannel(1.0f, hue, value) |
+          (FlowChannel(3.0f, hue, value) << 8u) |
+          (FlowChannel(5.0f, hue, value) << 16u) |
+          0xff000000u;
+    }
+  }
+
+#ifdef LIBCARLA_SIMD_X86
+
+  // ===========================================================================
+  // -- SSE2 kernels -----------------------------------------------------------
+  // ===========================================================================
+
+  static inline __m128i EncodedDepthSSE2(__m128i pixels) {
+    const __m128i byte_mask = _mm_set1_epi32(0xff);
+    const __m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), byte_mask);
+    const __m128i green = _mm_and_si128(pixels, _mm_set1_epi32(0xff00));
+    const __m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, byte_mask), 16);
+    return _mm_or_si128(_mm_or_si128(red, green), blue);
+  }
+
+  static inline __m128i GrayscalePixelSSE2(__m128i value) {
+    const __m128i rg = _mm_or_si128(value, _mm_slli_epi32(value, 8));
+    const __m128i rgb = _mm_or_si128(rg, _mm_slli_epi32(value, 16));
+    return _mm_or_si128(rgb, _mm_set1_epi32(static_cast<int>(0xff000000u)));
+  }
+
+  // Division, product and sum are kept as separate instructions, as in the
+  // scalar converter, so both produce bit-identical results.
+  static void DepthSSE2(const uint32_t *src, uint32_t *dst, size_t count) {
+    const __m128 max_depth = _mm_set1_ps(static_cast<float>(256 * 256 * 256 - 1));
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+      const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      const __m128 depth = _mm_cvtepi32_ps(EncodedDepthSSE2(pixels));
+      const __m128 normalized = _mm_div_ps(depth, max_depth);
+      const __m128i value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(normalized, scale), half));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), GrayscalePixelSSE2(value));
+    }
+    DepthScalar(src + i, dst + i, count - i);
+  }
+
+  // ===========================================================================
+  // -- AVX2 kernels -----------------------------------------------------------
+  // ===========================================================================
+
+  LIBCARLA_TARGET_AVX2
+  static inline __m256i EncodedDepthAVX2(__m256i pixels) {
+    const __m256i byte_mask = _mm256_set1_epi32(0xff);
+    const __m256i red = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), byte_mask);
+    const __m256i green = _mm256_and_si256(pixels, _mm256_set1_epi32(0xff00));
+    const __m256i blue = _mm256_slli_epi32(_mm256_and_si256(pixels, byte_mask), 16);
+    return _mm256_or_si256(_mm256_or_si256(red, green), blue);
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static inline __m256i GrayscalePixelAVX2(__m256i value) {
+    const __m256i rg = _mm256_or_si256(value, _mm256_slli_epi32(value, 8));
+    const __m256i rgb = _mm256_or_si256(rg, _mm256_slli_epi32(value, 16));
+    return _mm256_or_si256(rgb, _mm256_set1_epi32(static_cast<int>(0xff000000u)));
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static void DepthAVX2(const uint32_t *src, uint32_t *dst, size_t count) {
+    const __m256 max_depth = _mm256_set1_ps(static_cast<float>(256 * 256 * 256 - 1));
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      const __m256 depth = _mm256_cvtepi32_ps(EncodedDepthAVX2(pixels));
+      const __m256 normalized = _mm256_div_ps(depth, max_depth);
+      const __m256i value = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(normalized, scale), half));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), GrayscalePixelAVX2(value));
+    }
+    DepthScalar(src + i, dst + i, count - i);
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static void LogarithmicDepthAVX2(const uint32_t *src, uint32_t *dst, size_t count) {
+    const auto &table = GetLogarithmicDepthTable();
+    if (!table.single_step) {
+      LogarithmicDepthScalar(src, dst, count);
+      return;
+    }
+    const int *buckets = reinterpret_cast<const int *>(table.buckets.data());
+    const __m256i byte_mask = _mm256_set1_epi32(0xff);
+    const __m256i offset_mask = _mm256_set1_epi32(DepthLevelTable::bucket_size - 1);
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      const __m256i depth = EncodedDepthAVX2(pixels);
+      const __m256i entry = _mm256_i32gather_epi32(
+          buckets,
+          _mm256_srli_epi32(depth, DepthLevelTable::bucket_bits),
+          4);
+      // Offsets are at most 256, so the signed comparison is safe.
+      const __m256i below = _mm256_cmpgt_epi32(
+          _mm256_srli_epi32(entry, 8),
+          _mm256_and_si256(depth, offset_mask));
+      // below is -1 where the next level has not been reached yet.
+      const __m256i value = _mm256_add_epi32(
+          _mm256_add_epi32(_mm256_and_si256(entry, byte_mask), _mm256_set1_epi32(1)),
+          below);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), GrayscalePixelAVX2(value));
+    }
+    LogarithmicDepthScalar(src + i, dst + i, count - i);
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static void CityScapesPaletteAVX2(const uint32_t *src, uint32_t *dst, size_t count) {
+    const int *colors = reinterpret_cast<const int *>(GetPaletteTable().colors.data());
+    const __m256i byte_mask = _mm256_set1_epi32(0xff);
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      const __m256i tags = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), byte_mask);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i *>(dst + i),
+          _mm256_i32gather_epi32(colors, tags, 4));
+    }
+    CityScapesPaletteScalar(src + i, dst + i, count - i);
+  }
+
+
+  LIBCARLA_TARGET_AVX2
+  static inline __m256 SelectAVX2(__m256 mask, __m256 a, __m256 b) {
+    return _mm256_blendv_ps(b, a, mask);
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static inline __m256 FastAtan2AVX2(__m256 y, __m256 x) {
+    using C = FlowConstants;
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 ax = _mm256_andnot_ps(sign_mask, x);
+    const __m256 ay = _mm256_andnot_ps(sign_mask, y);
+    const __m256 a = _mm256_div_ps(
+        _mm256_min_ps(ax, ay),
+        _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(std::numeric_limits<float>::min())));
+    const __m256 s = _mm256_mul_ps(a, a);
+    __m256 r = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(C::atan_c1), s), _mm256_set1_ps(C::atan_c2));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(C::atan_c3));
+    r = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r, s), a), a);
+    r = SelectAVX2(_mm256_cmp_ps(ay, ax, _CMP_GT_OQ), _mm256_sub_ps(_mm256_set1_ps(C::half_pi), r), r);
+    r = SelectAVX2(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), _mm256_sub_ps(_mm256_set1_ps(C::pi), r), r);
+    return SelectAVX2(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), _mm256_xor_ps(r, sign_mask), r);
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static inline __m256 FastLogAVX2(__m256 x) {
+    using C = FlowConstants;
+    const __m256i bits = _mm256_castps_si256(x);
+    __m256 exponent = _mm256_cvtepi32_ps(
+        _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+        _mm256_set1_epi32(0x3f800000)));
+    const __m256 large = _mm256_cmp_ps(m, _mm256_set1_ps(C::sqrt2), _CMP_GT_OQ);
+    m = SelectAVX2(large, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), m);
+    exponent = SelectAVX2(large, _mm256_add_ps(exponent, _mm256_set1_ps(1.0f)), exponent);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 t = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+    const __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 series = _mm256_add_ps(_mm256_mul_ps(t2, _mm256_set1_ps(1.0f / 7.0f)), _mm256_set1_ps(1.0f / 5.0f));
+    series = _mm256_add_ps(_mm256_mul_ps(series, t2), _mm256_set1_ps(1.0f / 3.0f));
+    series = _mm256_add_ps(_mm256_mul_ps(series, t2), one);
+    return _mm256_add_ps(
+        _mm256_mul_ps(exponent, _mm256_set1_ps(C::ln2)),
+        _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), t), series));
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static inline __m256i FlowChannelAVX2(float n, __m256 hue, __m256 value) {
+    const __m256 six = _mm256_set1_ps(6.0f);
+    __m256 k = _mm256_add_ps(_mm256_set1_ps(n), hue);
+    k = SelectAVX2(_mm256_cmp_ps(k, six, _CMP_GE_OQ), _mm256_sub_ps(k, six), k);
+    const __m256 weight = _mm256_min_ps(
+        _mm256_max_ps(_mm256_min_ps(k, _mm256_sub_ps(_mm256_set1_ps(4.0f), k)), _mm256_setzero_ps()),
+        _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(_mm256_mul_ps(
+        _mm256_sub_ps(value, _mm256_mul_ps(value, weight)),
+        _mm256_set1_ps(255.0f)));
+  }
+
+  LIBCARLA_TARGET_AVX2
+  static void OpticalFlowAVX2(const float *src, uint32_t *dst, size_t count) {
+    using C = FlowConstants;
+    const __m256 scale = _mm256_set1_ps(C::IntensityScale());
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 full_turn = _mm256_set1_ps(360.0f);
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      // Deinterleave the (x, y) pairs of 8 pixels.
+      const __m256 first = _mm256_loadu_ps(src + 2u * i);
+      const __m256 second = _mm256_loadu_ps(src + 2u * i + 8u);
+      const __m256 x = _mm256_castpd_ps(_mm256_permute4x64_pd(
+          _mm256_castps_pd(_mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0))),
+          _MM_SHUFFLE(3, 1, 2, 0)));
+      const __m256 y = _mm256_castpd_ps(_mm256_permute4x64_pd(
+          _mm256_castps_pd(_mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1))),
+          _MM_SHUFFLE(3, 1, 2, 0)));
+      __m256 angle = _mm256_add_ps(
+          _mm256_set1_ps(180.0f),
+          _mm256_mul_ps(FastAtan2AVX2(y, x), _mm256_set1_ps(C::rad2deg)));
+      angle = SelectAVX2(_mm256_cmp_ps(angle, zero, _CMP_LT_OQ), _mm256_add_ps(angle, full_turn), angle);
+      angle = SelectAVX2(_mm256_cmp_ps(angle, full_turn, _CMP_GE_OQ), _mm256_sub_ps(angle, full_turn), angle);
+      const __m256 hue = _mm256_mul_ps(angle, _mm256_set1_ps(1.0f / 60.0f));
+      const __m256 norm = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+      const __m256 value = _mm256_min_ps(
+          _mm256_max_ps(_mm256_mul_ps(scale, FastLogAVX2(_mm256_add_ps(norm, _mm256_set1_ps(C::shift)))), zero),
+          one);
+      const __m256i pixels = _mm256_or_si256(
+          _mm256_or_si256(
+              FlowChannelAVX2(1.0f, hue, value),
+              _mm256_slli_epi32(FlowChannelAVX2(3.0f, hue, value), 8)),
+          _mm256_or_si256(
+              _mm256_slli_epi32(FlowChannelAVX2(5.0f, hue, value), 16),
+              _mm256_set1_epi32(static_cast<int>(0xff000000u))));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), pixels);
+    }
+    OpticalFlowScalar(src + 2u * i, dst + i, count - i);
+  }
+
+#endif // LIBCARLA_SIMD_X86
+
+  // ===========================================================================
+  // -- Dispatch ---------------------------------------------------------------
+  // ===========================================================================
+
+  struct ColorKernels {
+    Kernel depth = &DepthScalar;
+    Kernel logarithmic_depth = &LogarithmicDepthScalar;
+    Kernel cityscapes_palette = &CityScapesPaletteScalar;
+    FlowKernel optical_flow = &OpticalFlowScalar;
+  };
+
+  static const ColorKernels &GetColorKernels() {
+    static const ColorKernels kernels = [] {
+      ColorKernels result;
+#ifdef LIBCARLA_SIMD_X86
+      result.depth = &DepthSSE2;
+      if (HasAVX2()) {
+        result.depth = &DepthAVX2;
+        result.logarithmic_depth = &LogarithmicDepthAVX2;
+        result.cityscapes_palette = &CityScapesPaletteAVX2;
+        result.optical_flow = &OpticalFlowAVX2;
+      }
+#endif // LIBCARLA_SIMD_X86
+      return result;
+    }();
+    return kernels;
+  }
+
+} // namespace image_kernels
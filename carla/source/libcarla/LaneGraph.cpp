@@ -0,0 +1,646 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/FileSystem.h>
+#include <carla/client/Map.h>
+#include <carla/client/Waypoint.h>
+#include <carla/geom/Location.h>
+#include <carla/road/element/LaneMarking.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/// 64-bit FNV-1a hash of an OpenDRIVE file, identifies the map a cached
+/// structure was derived from.
+static uint64_t HashOpenDrive(const std::string &content) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : content) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash ^ content.size();
+}
+
+/// Decision taken at each waypoint of a route, same values as the RoadOption
+/// of the Python agents.
+enum class ERoadOption : int32_t {
+  Void = -1,
+  Left = 1,
+  Right = 2,
+  Straight = 3,
+  LaneFollow = 4,
+  ChangeLaneLeft = 5,
+  ChangeLaneRight = 6
+};
+
+/// Lanes of the map sampled every few meters, as a directed graph with an
+/// edge from each waypoint to the next one along its lane, from the end of
+/// a lane to the start of its successors, and to the neighbouring lanes
+/// where a lane change is allowed. Built from the same topology as the
+/// Python GlobalRoutePlanner.
+class LaneGraph : private boost::noncopyable {
+public:
+
+  using WaypointPtr = carla::SharedPtr<carla::client::Waypoint>;
+
+  using LaneChange = carla::road::element::LaneMarking::LaneChange;
+
+  struct Edge {
+    uint32_t from;
+    uint32_t to;
+    float length;
+    /// None when following the lane, Left or Right for lane changes.
+    LaneChange type;
+  };
+
+  LaneGraph(const carla::client::Map &map, double resolution)
+    : _resolution(resolution) {
+    if (!(resolution > 0.0)) {
+      throw std::invalid_argument("resolution must be positive");
+    }
+    const auto topology = map.GetTopology();
+    std::map<NodeKey, uint32_t> walked;
+    for (auto &segment : topology) {
+      const auto entry = GetOrAddNode(segment.first);
+      auto it = walked.find(GetKey(*segment.first));
+      if (it == walked.end()) {
+        it = walked.emplace(GetKey(*segment.first), WalkLane(entry)).first;
+      }
+      AddEdge(it->second, GetOrAddNode(segment.second), LaneChange::None);
+    }
+    AddLaneChanges();
+    std::stable_sort(_edges.begin(), _edges.end(), [](const Edge &a, const Edge &b) {
+      return a.from < b.from;
+    });
+    ComputeOffsets();
+  }
+
+  /// Writes the graph in the format read by Load. @a content_hash is the
+  /// HashOpenDrive of the map it was built from.
+  void Save(std::ostream &out, uint64_t content_hash) const {
+    FileHeader header;
+    std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+    header.version = kFileVersion;
+    header.content_hash = content_hash;
+    header.resolution = _resolution;
+    header.node_count = _waypoints.size();
+    header.edge_count = _edges.size();
+    std::vector<FileNode> nodes(_waypoints.size());
+    for (size_t i = 0u; i < nodes.size(); ++i) {
+      const auto &waypoint = *_waypoints[i];
+      nodes[i] = FileNode{
+          waypoint.GetRoadId(),
+          waypoint.GetSectionId(),
+          waypoint.GetLaneId(),
+          _locations[i].x,
+          _locations[i].y,
+          _locations[i].z,
+          waypoint.GetDistance()};
+    }
+    Write(out, &header, 1u);
+    Write(out, nodes.data(), nodes.size());
+    Write(out, _edges.data(), _edges.size());
+  }
+
+  /// Reads a graph written by Save for the same OpenDRIVE content and
+  /// resolution. Returns null if @a in does not hold such a graph.
+  ///
+  /// Only the waypoints of the nodes are looked up in @a map, sampling the
+  /// lanes and linking them again is skipped.
+  static std::shared_ptr<const LaneGraph> Load(
+      const carla::client::Map &map,
+      double resolution,
+      uint64_t content_hash,
+      std::istream &in) {
+    FileHeader header;
+    if (!Read(in, &header, 1u) ||
+        (std::memcmp(header.magic, kFileMagic, sizeof(header.magic)) != 0) ||
+        (header.version != kFileVersion) ||
+        (header.content_hash != content_hash) ||
+        (header.resolution != resolution) ||
+        (header.node_count >= std::numeric_limits<uint32_t>::max())) {
+      return nullptr;
+    }
+    std::vector<FileNode> nodes(static_cast<size_t>(header.node_count));
+    std::shared_ptr<LaneGraph> graph(new LaneGraph(resolution));
+    graph->_edges.resize(static_cast<size_t>(header.edge_count));
+    if (!Read(in, nodes.data(), nodes.size()) ||
+        !Read(in, graph->_edges.data(), graph->_edges.size())) {
+      return nullptr;
+    }
+    graph->_waypoints.reserve(nodes.size());
+    graph->_locations.reserve(nodes.size());
+    for (auto &node : nodes) {
+      auto waypoint = map.GetWaypointXODR(node.road_id, node.lane_id, static_cast<float>(node.s));
+      if ((waypoint == nullptr) || (waypoint->GetSectionId() != node.section_id)) {
+        return nullptr;
+      }
+      const auto index = static_cast<uint32_t>(graph->_waypoints.size());
+      const NodeKey key{node.road_id, node.section_id, node.lane_id, static_cast<int64_t>(std::llround(node.s * 1e3))};
+      if (!graph->_nodes.emplace(key, index).second) {
+        return nullptr;
+      }
+      graph->_lanes[LaneKey{node.road_id, node.section_id, node.lane_id}].emplace_back(node.s, index);
+      graph->_waypoints.emplace_back(std::move(waypoint));
+      graph->_locations.emplace_back(node.x, node.y, node.z);
+    }
+    for (auto &lane : graph->_lanes) {
+      std::sort(lane.second.begin(), lane.second.end());
+    }
+    for (size_t i = 0u; i < graph->_edges.size(); ++i) {
+      const auto &edge = graph->_edges[i];
+      if ((edge.from >= nodes.size()) || (edge.to >= nodes.size()) ||
+          ((i > 0u) && (edge.from < graph->_edges[i - 1u].from))) {
+        return nullptr;
+      }
+    }
+    graph->ComputeOffsets();
+    return graph;
+  }
+
+  double GetResolution() const {
+    return _resolution;
+  }
+
+  size_t GetNodeCount() const {
+    return _waypoints.size();
+  }
+
+  const WaypointPtr &GetWaypoint(uint32_t node) const {
+    return _waypoints[node];
+  }
+
+  const carla::geom::Location &GetLocation(uint32_t node) const {
+    return _locations[node];
+  }
+
+  /// Edges sorted by their source node.
+  const std::vector<Edge> &GetEdges() const {
+    return _edges;
+  }
+
+  /// Outgoing edges of @a node, as a range of GetEdges().
+  std::pair<const Edge *, const Edge *> GetOutEdges(uint32_t node) const {
+    return {_edges.data() + _offsets[node], _edges.data() + _offsets[node + 1u]};
+  }
+
+  /// Node closest to @a waypoint along its lane, or the closest node in
+  /// space if its lane is not part of the graph.
+  uint32_t FindNode(const carla::client::Waypoint &waypoint) const {
+    const auto lane = _lanes.find(GetLaneKey(waypoint));
+    if (lane != _lanes.end()) {
+      return FindInLane(lane->second, waypoint.GetDistance());
+    }
+    const auto location = waypoint.GetTransform().location;
+    uint32_t result = 0u;
+    float best = std::numeric_limits<float>::max();
+    for (uint32_t node = 0u; node < _locations.size(); ++node) {
+      const float distance = _locations[node].SquaredDistance(location);
+      if (distance < best) {
+        best = distance;
+        result = node;
+      }
+    }
+    return result;
+  }
+
+  struct RouteStep {
+    uint32_t node;
+    ERoadOption option;
+  };
+
+  /// Shortest route from @a origin to @a destination found with A*, empty
+  /// if @a destination cannot be reached. Thread-safe.
+  std::vector<RouteStep> PlanRoute(uint32_t origin, uint32_t destination) const {
+    auto &search = GetSearchState();
+    const uint32_t none = std::numeric_limits<uint32_t>::max();
+    const auto &target = _locations[destination];
+    using Entry = std::pair<float, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    search.Visit(origin, 0.0f, none);
+    open.emplace(_locations[origin].Distance(target), origin);
+    while (!open.empty()) {
+      const auto node = open.top().second;
+      const auto estimate = open.top().first;
+      open.pop();
+      if (node == destination) {
+        break;
+      }
+      const float cost = search.cost[node];
+      if (estimate > cost + _locations[node].Distance(target) + 1e-3f) {
+        continue; // Stale entry, the node was reached later with a lower cost.
+      }
+      for (auto it = _edges.begin() + static_cast<std::ptrdiff_t>(_offsets[node]),
+                end = _edges.begin() + static_cast<std::ptrdiff_t>(_offsets[node + 1u]);
+           it != end; ++it) {
+        const float next_cost = cost + it->length;
+        if (search.IsBetter(it->to, next_cost)) {
+          search.Visit(it->to, next_cost, static_cast<uint32_t>(it - _edges.begin()));
+          open.emplace(next_cost + _locations[it->to].Distance(target), it->to);
+        }
+      }
+    }
+    if (!search.IsVisited(destination)) {
+      return {};
+    }
+    std::vector<RouteStep> route;
+    for (uint32_t node = destination;;) {
+      const uint32_t edge = search.parent[node];
+      route.push_back(RouteStep{node, edge == none ? ERoadOption::LaneFollow : GetOption(_edges[edge])});
+      if (edge == none) {
+        break;
+      }
+      node = _edges[edge].from;
+    }
+    std::reverse(route.begin(), route.end());
+    SetTurnDecisions(route);
+    return route;
+  }
+
+private:
+
+  /// Cache file layout: a FileHeader, then node_count FileNode and
+  /// edge_count Edge, in native byte order. The version changes with the
+  /// layout.
+  static constexpr char kFileMagic[4u] = {'C', 'L', 'G', 'R'};
+
+  static constexpr uint32_t kFileVersion = 1u;
+
+  struct FileHeader {
+    char magic[4u];
+    uint32_t version;
+    uint64_t content_hash;
+    double resolution;
+    uint64_t node_count;
+    uint64_t edge_count;
+  };
+
+  struct FileNode {
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    float x;
+    float y;
+    float z;
+    double s;
+  };
+
+  template <typename T>
+  static void Write(std::ostream &out, const T *data, size_t count) {
+    out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(sizeof(T) * count));
+  }
+
+  template <typename T>
+  static bool Read(std::istream &in, T *data, size_t count) {
+    const auto size = static_cast<std::streamsize>(sizeof(T) * count);
+    return in.read(reinterpret_cast<char *>(data), size) && (in.gcount() == size);
+  }
+
+  explicit LaneGraph(double resolution)
+    : _resolution(resolution) {}
+
+  /// Fills _offsets from the edges, which must be sorted by source node.
+  void ComputeOffsets() {
+    _offsets.assign(_waypoints.size() + 1u, 0u);
+    for (auto &edge : _edges) {
+      ++_offsets[edge.from + 1u];
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+  }
+
+  /// Road, section and lane ids, and the distance along the road in mm so
+  /// that the same point reached from two lanes gives the same node.
+  using NodeKey = std::tuple<uint32_t, uint32_t, int32_t, int64_t>;
+
+  using LaneKey = std::tuple<uint32_t, uint32_t, int32_t>;
+
+  static NodeKey GetKey(const carla::client::Waypoint &waypoint) {
+    return NodeKey{
+        waypoint.GetRoadId(),
+        waypoint.GetSectionId(),
+        waypoint.GetLaneId(),
+        static_cast<int64_t>(std::llround(waypoint.GetDistance() * 1e3))};
+  }
+
+  static LaneKey GetLaneKey(const carla::client::Waypoint &waypoint) {
+    return LaneKey{waypoint.GetRoadId(), waypoint.GetSectionId(), waypoint.GetLaneId()};
+  }
+
+  /// Costs and parents of an A* search, reused between the searches of a
+  /// thread. A node is only valid if its stamp matches the current search.
+  struct SearchState {
+    std::vector<float> cost;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp;
+    uint32_t current = 0u;
+
+    void Reset(size_t nodes) {
+      if ((stamp.size() != nodes) || (++current == 0u)) {
+        cost.resize(nodes);
+        parent.resize(nodes);
+        stamp.assign(nodes, 0u);
+        current = 1u;
+      }
+    }
+
+    bool IsVisited(uint32_t node) const {
+      return stamp[node] == current;
+    }
+
+    bool IsBetter(uint32_t node, float value) const {
+      return !IsVisited(node) || (value < cost[node]);
+    }
+
+    void Visit(uint32_t node, float value, uint32_t edge) {
+      stamp[node] = current;
+      cost[node] = value;
+      parent[node] = edge;
+    }
+  };
+
+  SearchState &GetSearchState() const {
+    thread_local SearchState state;
+    state.Reset(_waypoints.size());
+    return state;
+  }
+
+  static ERoadOption GetOption(const Edge &edge) {
+    switch (edge.type) {
+      case LaneChange::Left:
+        return ERoadOption::ChangeLaneLeft;
+      case LaneChange::Right:
+        return ERoadOption::ChangeLaneRight;
+      default:
+        return ERoadOption::LaneFollow;
+    }
+  }
+
+  /// Marks the nodes of each junction crossed by @a route as Left, Right or
+  /// Straight, from the heading before and after the junction.
+  void SetTurnDecisions(std::vector<RouteStep> &route) const {
+    for (size_t i = 0u; i < route.size(); ++i) {
+      if (!_waypoints[route[i].node]->IsJunction()) {
+        continue;
+      }
+      size_t end = i;
+      while ((end < route.size()) && _waypoints[route[end].node]->IsJunction()) {
+        ++end;
+      }
+      const auto &before = _waypoints[route[i > 0u ? i - 1u : i].node];
+      const auto &after = _waypoints[route[end < route.size() ? end : end - 1u].node];
+      double delta = after->GetTransform().rotation.yaw - before->GetTransform().rotation.yaw;
+      delta = std::remainder(delta, 360.0);
+      const auto option =
+          std::abs(delta) < 35.0 ? ERoadOption::Straight :
+          delta < 0.0 ? ERoadOption::Left :
+          ERoadOption::Right;
+      for (; i < end; ++i) {
+        route[i].option = option;
+      }
+    }
+  }
+
+  /// Closest node to @a s in the sorted samples of a lane.
+  static uint32_t FindInLane(const std::vector<std::pair<double, uint32_t>> &samples, double s) {
+    auto it = std::lower_bound(samples.begin(), samples.end(), std::make_pair(s, uint32_t(0u)));
+    if ((it == samples.end()) ||
+        ((it != samples.begin()) && (s - std::prev(it)->first < it->first - s))) {
+      --it;
+    }
+    return it->second;
+  }
+
+  uint32_t GetOrAddNode(const WaypointPtr &waypoint) {
+    const auto result = _nodes.emplace(GetKey(*waypoint), static_cast<uint32_t>(_waypoints.size()));
+    if (result.second) {
+      _waypoints.emplace_back(waypoint);
+      _locations.emplace_back(waypoint->GetTransform().location);
+      _lanes[GetLaneKey(*waypoint)].emplace_back(waypoint->GetDistance(), result.first->second);
+    }
+    return result.first->second;
+  }
+
+  void AddEdge(uint32_t from, uint32_t to, LaneChange type) {
+    if (from != to) {
+      _edges.push_back(Edge{from, to, _locations[from].Distance(_locations[to]), type});
+    }
+  }
+
+  /// Samples the lane of @a entry up to its end, returns the last node.
+  uint32_t WalkLane(uint32_t entry) {
+    const auto lane = GetLaneKey(*_waypoints[entry]);
+    uint32_t current = entry;
+    for (;;) {
+      const auto next = _waypoints[current]->GetNext(_resolution);
+      if ((next.size() != 1u) || (GetLaneKey(*next.front()) != lane)) {
+        return current;
+      }
+      const auto node = GetOrAddNode(next.front());
+      if (node == current) {
+        return current;
+      }
+      AddEdge(current, node, LaneChange::None);
+      current = node;
+    }
+  }
+
+  /// Links every node outside junctions to the closest node of the lane on
+  /// each side it is allowed to change to.
+  void AddLaneChanges() {
+    for (auto &lane : _lanes) {
+      std::sort(lane.second.begin(), lane.second.end());
+    }
+    const auto count = static_cast<uint32_t>(_waypoints.size());
+    for (uint32_t node = 0u; node < count; ++node) {
+      const auto &waypoint = _waypoints[node];
+      if (waypoint->IsJunction()) {
+        continue;
+      }
+      const auto allowed = static_cast<uint8_t>(waypoint->GetLaneChange());
+      if ((allowed & static_cast<uint8_t>(LaneChange::Left)) != 0u) {
+        AddLaneChange(node, waypoint->GetLeft(), LaneChange::Left);
+      }
+      if ((allowed & static_cast<uint8_t>(LaneChange::Right)) != 0u) {
+        AddLaneChange(node, waypoint->GetRight(), LaneChange::Right);
+      }
+    }
+  }
+
+  void AddLaneChange(uint32_t from, const WaypointPtr &target, LaneChange type) {
+    if ((target == nullptr) ||
+        (target->GetType() != carla::road::Lane::LaneType::Driving) ||
+        (target->GetRoadId() != _waypoints[from]->GetRoadId())) {
+      return;
+    }
+    const auto lane = _lanes.find(GetLaneKey(*target));
+    if (lane == _lanes.end()) {
+      return;
+    }
+    AddEdge(from, FindInLane(lane->second, target->GetDistance()), type);
+  }
+
+  const double _resolution;
+
+  std::vector<WaypointPtr> _waypoints;
+
+  std::vector<carla::geom::Location> _locations;
+
+  std::map<NodeKey, uint32_t> _nodes;
+
+  /// Nodes of each lane as (s, node) pairs.
+  std::map<LaneKey, std::vector<std::pair<double, uint32_t>>> _lanes;
+
+  std::vector<Edge> _edges;
+
+  /// Edges of node i are in [_offsets[i], _offsets[i + 1]).
+  std::vector<size_t> _offsets;
+};
+
+constexpr char LaneGraph::kFileMagic[4u];
+
+/// Lane graphs of the last maps used, so routes are planned without
+/// rebuilding the graph. An entry keeps its map alive through the
+/// waypoints of the graph, so the map address identifies it.
+///
+/// If a cache directory is set, graphs are also saved there, named after
+/// the hash of the OpenDRIVE content and the resolution, and later loaded
+/// by any process using the same map instead of being built again. The
+/// directory defaults to the CARLA_MAP_CACHE_DIR environment variable.
+class LaneGraphCache : private boost::noncopyable {
+public:
+
+  static std::shared_ptr<const LaneGraph> Get(const carla::client::Map &map, double resolution) {
+    return GetInstance().Find(map, resolution);
+  }
+
+  static void SetDirectory(std::string directory) {
+    auto &cache = GetInstance();
+    std::lock_guard<std::mutex> lock(cache._directory_mutex);
+    cache._directory = std::move(directory);
+  }
+
+  static std::string GetDirectory() {
+    auto &cache = GetInstance();
+    std::lock_guard<std::mutex> lock(cache._directory_mutex);
+    return cache._directory;
+  }
+
+private:
+
+  using Key = std::pair<const carla::client::Map *, double>;
+
+  static constexpr size_t kCapacity = 4u;
+
+  LaneGraphCache() {
+    const char *directory = std::getenv("CARLA_MAP_CACHE_DIR");
+    if (directory != nullptr) {
+      _directory = directory;
+    }
+  }
+
+  static LaneGraphCache &GetInstance() {
+    static LaneGraphCache cache;
+    return cache;
+  }
+
+  std::shared_ptr<const LaneGraph> Find(const carla::client::Map &map, double resolution) {
+    const Key key{&map, resolution};
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &entry : _entries) {
+      if (entry.first == key) {
+        return entry.second;
+      }
+    }
+    auto graph = LoadOrBuild(map, resolution);
+    _entries.emplace_front(key, graph);
+    if (_entries.size() > kCapacity) {
+      _entries.pop_back();
+    }
+    return graph;
+  }
+
+  std::shared_ptr<const LaneGraph> LoadOrBuild(const carla::client::Map &map, double resolution) {
+    const auto directory = GetDirectory();
+    if (directory.empty()) {
+      return std::make_shared<const LaneGraph>(map, resolution);
+    }
+    const auto hash = HashOpenDrive(map.GetOpenDrive());
+    const auto path = GetFilePath(directory, hash, resolution);
+    {
+      std::ifstream in(path, std::ios::binary);
+      if (in) {
+        auto graph = LaneGraph::Load(map, resolution, hash, in);
+        if (graph != nullptr) {
+          return graph;
+        }
+      }
+    }
+    auto graph = std::make_shared<const LaneGraph>(map, resolution);
+    Store(*graph, path, hash);
+    return graph;
+  }
+
+  static std::string GetFilePath(const std::string &directory, uint64_t hash, double resolution) {
+    std::ostringstream path;
+    path << directory << '/' << std::hex << std::setfill('0') << std::setw(16) << hash
+         << std::dec << '-' << std::llround(resolution * 1e3) << ".lanegraph";
+    return path.str();
+  }
+
+  /// Writes a temporary file renamed once complete, so processes sharing the
+  /// directory never read a partial graph. The cache is only an
+  /// optimization, failing to write it is not an error.
+  static void Store(const LaneGraph &graph, std::string path, uint64_t hash) {
+    try {
+      carla::FileSystem::ValidateFilePath(path, ".lanegraph");
+      const auto temporary = path + '.' + std::to_string(std::random_device{}());
+      {
+        std::ofstream out(temporary, std::ios::binary);
+        graph.Save(out, hash);
+        if (!out) {
+          out.close();
+          std::remove(temporary.c_str());
+          return;
+        }
+      }
+      if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+      }
+    } catch (const std::exception &) {
+      // Keep the graph, it is still valid without the cache file.
+    }
+  }
+
+  std::mutex _mutex;
+
+  std::deque<std::pair<Key, std::shared_ptr<const LaneGraph>>> _entries;
+
+  std::mutex _directory_mutex;
+
+  std::string _directory;
+};
@@ -10,11 +10,25 @@
 #include <carla/client/Map.h>
 #include <carla/client/Waypoint.h>
 #include <carla/road/element/LaneMarking.h>
+#include <carla/road/element/Waypoint.h>
 #include <carla/client/Landmark.h>
 #include <carla/road/SignalType.h>
 
+#include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -32,6 +46,22 @@ namespace client {
 } // namespace client
 } // namespace carla
 
+namespace carla {
+namespace road {
+namespace element {
+
+  std::ostream &operator<<(std::ostream &out, const Waypoint &waypoint) {
+    out << "WaypointHandle(road_id=" << std::to_string(waypoint.road_id)
+        << ", section_id=" << std::to_string(waypoint.section_id)
+        << ", lane_id=" << std::to_string(waypoint.lane_id)
+        << ", s=" << std::to_string(waypoint.s) << ')';
+    return out;
+  }
+
+} // namespace element
+} // namespace road
+} // namespace carla
+
 static void SaveOpenDriveToDisk(const carla::client::Map &self, std::string path) {
   carla::PythonUtil::ReleaseGIL unlock;
   if (path.empty()) {
@@ -42,6 +72,32 @@ static void SaveOpenDriveToDisk(const carla::client::Map &self, std::string path
   out << self.GetOpenDrive() << std::endl;
 }
 
+/// Maps created from Python with the same name and OpenDRIVE content share
+/// a single instance while any of them is alive, so the content is parsed
+/// once per process. Maps are immutable, so sharing them is safe.
+static boost::shared_ptr<carla::client::Map> MakeMap(std::string name, std::string xodr_content) {
+  using MapPtr = boost::shared_ptr<carla::client::Map>;
+  using Key = std::pair<std::string, uint64_t>;
+  static std::mutex mutex;
+  static std::map<Key, boost::weak_ptr<carla::client::Map>> maps;
+  carla::PythonUtil::ReleaseGIL unlock;
+  const Key key{name, HashOpenDrive(xodr_content)};
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto it = maps.begin(); it != maps.end();) {
+    it = it->second.expired() ? maps.erase(it) : std::next(it);
+  }
+  auto it = maps.find(key);
+  if (it != maps.end()) {
+    MapPtr map = it->second.lock();
+    if ((map != nullptr) && (map->GetOpenDrive() == xodr_content)) {
+      return map;
+    }
+  }
+  auto map = boost::make_shared<carla::client::Map>(std::move(name), std::move(xodr_content));
+  maps[key] = map;
+  return map;
+}
+
 static auto GetTopology(const carla::client::Map &self) {
   namespace py = boost::python;
   auto topology = self.GetTopology();
@@ -78,6 +134,496 @@ static carla::geom::GeoLocation ToGeolocation(
   return self.GetGeoReference().Transform(location);
 }
 
+/// Exports the LaneGraph of @a self sampled every @a resolution meters as a
+/// dict of arrays, nodes and edges indexed by row.
+static boost::python::dict ExportLaneGraph(const carla::client::Map &self, double resolution) {
+  namespace py = boost::python;
+  std::shared_ptr<const LaneGraph> graph;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    graph = LaneGraphCache::Get(self, resolution);
+  }
+  const auto nodes = static_cast<Py_ssize_t>(graph->GetNodeCount());
+  const auto &edges = graph->GetEdges();
+  const auto edge_count = static_cast<Py_ssize_t>(edges.size());
+  py::dict result;
+  uint32_t *road_id = nullptr;
+  uint32_t *section_id = nullptr;
+  int32_t *lane_id = nullptr;
+  double *s = nullptr;
+  float *location = nullptr;
+  bool *is_junction = nullptr;
+  uint32_t *edge_nodes = nullptr;
+  float *edge_length = nullptr;
+  uint8_t *edge_type = nullptr;
+  result["road_id"] = MakeNumPyArray("I", {nodes}, road_id);
+  result["section_id"] = MakeNumPyArray("I", {nodes}, section_id);
+  result["lane_id"] = MakeNumPyArray("i", {nodes}, lane_id);
+  result["s"] = MakeNumPyArray("d", {nodes}, s);
+  result["location"] = MakeNumPyArray("f", {nodes, 3}, location);
+  result["is_junction"] = MakeNumPyArray("?", {nodes}, is_junction);
+  result["edges"] = MakeNumPyArray("I", {edge_count, 2}, edge_nodes);
+  result["edge_length"] = MakeNumPyArray("f", {edge_count}, edge_length);
+  result["edge_type"] = MakeNumPyArray("B", {edge_count}, edge_type);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    for (uint32_t i = 0u; i < graph->GetNodeCount(); ++i) {
+      const auto &waypoint = graph->GetWaypoint(i);
+      const auto &l = graph->GetLocation(i);
+      road_id[i] = waypoint->GetRoadId();
+      section_id[i] = waypoint->GetSectionId();
+      lane_id[i] = waypoint->GetLaneId();
+      s[i] = waypoint->GetDistance();
+      location[3u * i + 0u] = l.x;
+      location[3u * i + 1u] = l.y;
+      location[3u * i + 2u] = l.z;
+      is_junction[i] = waypoint->IsJunction();
+    }
+    for (size_t i = 0u; i < edges.size(); ++i) {
+      edge_nodes[2u * i + 0u] = edges[i].from;
+      edge_nodes[2u * i + 1u] = edges[i].to;
+      edge_length[i] = edges[i].length;
+      edge_type[i] = static_cast<uint8_t>(edges[i].type);
+    }
+  }
+  return result;
+}
+
+/// Localizes each of @a locations like Map.get_waypoint, in parallel and
+/// without creating a waypoint object per location. Returns a dict of
+/// arrays with a row per location, "valid" is false where no waypoint was
+/// found and the other columns are zero.
+static boost::python::dict GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  namespace py = boost::python;
+  const auto queries = ExtractLocations(locations);
+  const auto rows = static_cast<Py_ssize_t>(queries.size());
+  py::dict result;
+  bool *valid = nullptr;
+  uint32_t *road_id = nullptr;
+  uint32_t *section_id = nullptr;
+  int32_t *lane_id = nullptr;
+  double *s = nullptr;
+  float *location = nullptr;
+  float *rotation = nullptr;
+  float *lane_width = nullptr;
+  result["valid"] = MakeNumPyArray("?", {rows}, valid);
+  result["road_id"] = MakeNumPyArray("I", {rows}, road_id);
+  result["section_id"] = MakeNumPyArray("I", {rows}, section_id);
+  result["lane_id"] = MakeNumPyArray("i", {rows}, lane_id);
+  result["s"] = MakeNumPyArray("d", {rows}, s);
+  result["location"] = MakeNumPyArray("f", {rows, 3}, location);
+  result["rotation"] = MakeNumPyArray("f", {rows, 3}, rotation);
+  result["lane_width"] = MakeNumPyArray("f", {rows}, lane_width);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto &map = self.GetMap();
+    WorkerPool::Get().ParallelFor(queries.size(), 256u, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const auto waypoint = project_to_road ?
+            map.GetClosestWaypointOnRoad(queries[i], lane_type) :
+            map.GetWaypoint(queries[i], lane_type);
+        valid[i] = waypoint.has_value();
+        if (!valid[i]) {
+          road_id[i] = section_id[i] = 0u;
+          lane_id[i] = 0;
+          s[i] = 0.0;
+          std::fill(location + 3u * i, location + 3u * i + 3u, 0.0f);
+          std::fill(rotation + 3u * i, rotation + 3u * i + 3u, 0.0f);
+          lane_width[i] = 0.0f;
+          continue;
+        }
+        const auto transform = map.ComputeTransform(*waypoint);
+        road_id[i] = waypoint->road_id;
+        section_id[i] = waypoint->section_id;
+        lane_id[i] = waypoint->lane_id;
+        s[i] = waypoint->s;
+        location[3u * i + 0u] = transform.location.x;
+        location[3u * i + 1u] = transform.location.y;
+        location[3u * i + 2u] = transform.location.z;
+        rotation[3u * i + 0u] = transform.rotation.pitch;
+        rotation[3u * i + 1u] = transform.rotation.yaw;
+        rotation[3u * i + 2u] = transform.rotation.roll;
+        lane_width[i] = static_cast<float>(map.GetLaneWidth(*waypoint));
+      }
+    });
+  }
+  return result;
+}
+
+// =============================================================================
+// -- Waypoint handles ---------------------------------------------------------
+// =============================================================================
+
+/// road::element::Waypoint, the (road, section, lane, s) key of a waypoint,
+/// is exposed as carla.WaypointHandle and as rows of a structured array. The
+/// Map methods below take and return arrays of handles, so walking many
+/// waypoints does not allocate a carla.Waypoint per step.
+template <>
+struct ArrayRowTraits<carla::road::element::Waypoint> {
+  struct Row {
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    double s;
+  };
+
+  static std::string GetFormat() {
+    return StructFormat()
+        .Field(offsetof(Row, road_id), "I", sizeof(uint32_t), "road_id")
+        .Field(offsetof(Row, section_id), "I", sizeof(uint32_t), "section_id")
+        .Field(offsetof(Row, lane_id), "i", sizeof(int32_t), "lane_id")
+        .Field(offsetof(Row, s), "d", sizeof(double), "s")
+        .Build(sizeof(Row));
+  }
+
+  static Row MakeRow(const carla::road::element::Waypoint &waypoint) {
+    return {waypoint.road_id, waypoint.section_id, waypoint.lane_id, waypoint.s};
+  }
+};
+
+/// Reads an array returned by the handle methods of Map, any structured
+/// array with the same layout, or a sequence of carla.WaypointHandle.
+static std::vector<carla::road::element::Waypoint> ExtractHandles(const boost::python::object &handles) {
+  namespace py = boost::python;
+  namespace cre = carla::road::element;
+  using Row = ArrayRowTraits<cre::Waypoint>::Row;
+  if (!PyObject_CheckBuffer(handles.ptr())) {
+    return {py::stl_input_iterator<cre::Waypoint>(handles), py::stl_input_iterator<cre::Waypoint>()};
+  }
+  ScopedBuffer buffer(handles, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT);
+  const auto &view = buffer.view();
+  const std::string format = view.format != nullptr ? view.format : "";
+  if ((view.ndim != 1) ||
+      (view.itemsize != static_cast<Py_ssize_t>(sizeof(Row))) ||
+      (format.find(":road_id:") == std::string::npos) ||
+      (format.find(":lane_id:") == std::string::npos)) {
+    throw std::invalid_argument("handles must be an array returned by a Map handle method");
+  }
+  const auto *rows = static_cast<const Row *>(buffer.data());
+  std::vector<cre::Waypoint> result(static_cast<size_t>(view.shape[0]));
+  for (size_t i = 0u; i < result.size(); ++i) {
+    result[i].road_id = rows[i].road_id;
+    result[i].section_id = rows[i].section_id;
+    result[i].lane_id = rows[i].lane_id;
+    result[i].s = rows[i].s;
+  }
+  return result;
+}
+
+static boost::python::object IndicesToArray(const std::vector<uint32_t> &indices) {
+  uint32_t *data = nullptr;
+  auto result = MakeNumPyArray("I", {static_cast<Py_ssize_t>(indices.size())}, data);
+  std::copy(indices.begin(), indices.end(), data);
+  return result;
+}
+
+static boost::python::object FlagsToArray(const std::vector<bool> &flags) {
+  bool *data = nullptr;
+  auto result = MakeNumPyArray("?", {static_cast<Py_ssize_t>(flags.size())}, data);
+  std::copy(flags.begin(), flags.end(), data);
+  return result;
+}
+
+/// Returns (handles, valid), a handle per location like Map.get_waypoint,
+/// with a zero handle where no waypoint was found.
+static boost::python::tuple GetWaypointHandles(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  namespace cre = carla::road::element;
+  const auto queries = ExtractLocations(locations);
+  std::vector<cre::Waypoint> handles(queries.size());
+  std::vector<bool> valid(queries.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto &map = self.GetMap();
+    std::vector<uint8_t> found(queries.size());
+    WorkerPool::Get().ParallelFor(queries.size(), 256u, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const auto waypoint = project_to_road ?
+            map.GetClosestWaypointOnRoad(queries[i], lane_type) :
+            map.GetWaypoint(queries[i], lane_type);
+        found[i] = waypoint.has_value() ? 1u : 0u;
+        if (waypoint.has_value()) {
+          handles[i] = *waypoint;
+        }
+      }
+    });
+    std::copy(found.begin(), found.end(), valid.begin());
+  }
+  return boost::python::make_tuple(ToListOrArray(handles, true), FlagsToArray(valid));
+}
+
+/// Returns (handles, index), the waypoints @a distance ahead of each of
+/// @a handles, or behind if @a forward is false. A handle may branch into
+/// several waypoints or none, index holds the row of the handle each
+/// result comes from. Handles on lane 0, the zero handles of invalid rows,
+/// lead to none.
+static boost::python::tuple GetNextHandles(
+    const carla::client::Map &self,
+    const boost::python::object &handles,
+    double distance,
+    bool forward) {
+  namespace cre = carla::road::element;
+  const auto origins = ExtractHandles(handles);
+  std::vector<cre::Waypoint> result;
+  std::vector<uint32_t> index;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto &map = self.GetMap();
+    std::vector<std::vector<cre::Waypoint>> next(origins.size());
+    WorkerPool::Get().ParallelFor(origins.size(), 64u, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (origins[i].lane_id != 0) {
+          next[i] = forward ? map.GetNext(origins[i], distance) : map.GetPrevious(origins[i], distance);
+        }
+      }
+    });
+    for (size_t i = 0u; i < next.size(); ++i) {
+      result.insert(result.end(), next[i].begin(), next[i].end());
+      index.insert(index.end(), next[i].size(), static_cast<uint32_t>(i));
+    }
+  }
+  return boost::python::make_tuple(ToListOrArray(result, true), IndicesToArray(index));
+}
+
+/// Returns (handles, valid), the waypoint on the lane to the left of each of
+/// @a handles, or to the right if @a left is false. Handles on lane 0 have
+/// no side lane.
+static boost::python::tuple GetSideLaneHandles(
+    const carla::client::Map &self,
+    const boost::python::object &handles,
+    bool left) {
+  namespace cre = carla::road::element;
+  auto waypoints = ExtractHandles(handles);
+  std::vector<bool> valid(waypoints.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto &map = self.GetMap();
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      if (waypoints[i].lane_id == 0) {
+        valid[i] = false;
+        continue;
+      }
+      const auto side = left ? map.GetLeft(waypoints[i]) : map.GetRight(waypoints[i]);
+      valid[i] = side.has_value();
+      waypoints[i] = side.has_value() ? *side : cre::Waypoint{};
+    }
+  }
+  return boost::python::make_tuple(ToListOrArray(waypoints, true), FlagsToArray(valid));
+}
+
+/// Returns the transforms of @a handles as an N x 6 array of (x, y, z,
+/// pitch, yaw, roll) rows, the layout CommandBatch.apply_transform reads.
+/// Handles on lane 0, the zero handles of invalid rows, give NaN rows.
+static boost::python::object GetHandleTransforms(
+    const carla::client::Map &self,
+    const boost::python::object &handles) {
+  const auto waypoints = ExtractHandles(handles);
+  float *data = nullptr;
+  auto result = MakeNumPyArray("f", {static_cast<Py_ssize_t>(waypoints.size()), 6}, data);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto &map = self.GetMap();
+    WorkerPool::Get().ParallelFor(waypoints.size(), 256u, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        auto *row = data + 6u * i;
+        if (waypoints[i].lane_id == 0) {
+          std::fill(row, row + 6u, std::numeric_limits<float>::quiet_NaN());
+          continue;
+        }
+        const auto transform = map.ComputeTransform(waypoints[i]);
+        row[0u] = transform.location.x;
+        row[1u] = transform.location.y;
+        row[2u] = transform.location.z;
+        row[3u] = transform.rotation.pitch;
+        row[4u] = transform.rotation.yaw;
+        row[5u] = transform.rotation.roll;
+      }
+    });
+  }
+  return result;
+}
+
+/// Materializes a carla.Waypoint per handle, None for invalid handles. The
+/// zero handles of invalid rows have lane 0, the center lane, which is
+/// never a waypoint.
+static boost::python::list HandlesToWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &handles) {
+  const auto waypoints = ExtractHandles(handles);
+  std::vector<carla::SharedPtr<carla::client::Waypoint>> objects;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    objects.reserve(waypoints.size());
+    for (auto &waypoint : waypoints) {
+      carla::SharedPtr<carla::client::Waypoint> object;
+      if (waypoint.lane_id != 0) {
+        object = self.GetWaypointXODR(waypoint.road_id, waypoint.lane_id, static_cast<float>(waypoint.s));
+      }
+      if ((object != nullptr) && (object->GetSectionId() != waypoint.section_id)) {
+        object = nullptr;
+      }
+      objects.emplace_back(std::move(object));
+    }
+  }
+  boost::python::list result;
+  for (auto &object : objects) {
+    result.append(object);
+  }
+  return result;
+}
+
+static carla::road::element::Waypoint GetHandle(const carla::client::Waypoint &self) {
+  carla::road::element::Waypoint result;
+  result.road_id = self.GetRoadId();
+  result.section_id = self.GetSectionId();
+  result.lane_id = self.GetLaneId();
+  result.s = self.GetDistance();
+  return result;
+}
+
+/// Route between the driving lanes closest to @a origin and @a destination.
+static std::vector<LaneGraph::RouteStep> PlanRouteSteps(
+    const carla::client::Map &map,
+    const LaneGraph &graph,
+    const carla::geom::Location &origin,
+    const carla::geom::Location &destination) {
+  const auto from = map.GetWaypoint(origin);
+  const auto to = map.GetWaypoint(destination);
+  if ((from == nullptr) || (to == nullptr)) {
+    return {};
+  }
+  return graph.PlanRoute(graph.FindNode(*from), graph.FindNode(*to));
+}
+
+static boost::python::list RouteToList(const LaneGraph &graph, const std::vector<LaneGraph::RouteStep> &route) {
+  namespace py = boost::python;
+  py::list result;
+  for (auto &step : route) {
+    result.append(py::make_tuple(graph.GetWaypoint(step.node), step.option));
+  }
+  return result;
+}
+
+static boost::python::list PlanRoute(
+    const carla::client::Map &self,
+    const carla::geom::Location &origin,
+    const carla::geom::Location &destination,
+    double resolution) {
+  std::shared_ptr<const LaneGraph> graph;
+  std::vector<LaneGraph::RouteStep> route;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    graph = LaneGraphCache::Get(self, resolution);
+    route = PlanRouteSteps(self, *graph, origin, destination);
+  }
+  return RouteToList(*graph, route);
+}
+
+/// Plans a route per pair of @a origins and @a destinations in parallel.
+/// With @a as_array each route is a pair of arrays, the nodes in the lane
+/// graph of the same resolution and the RoadOption of each node.
+static boost::python::list PlanRoutes(
+    const carla::client::Map &self,
+    const boost::python::object &origins,
+    const boost::python::object &destinations,
+    double resolution,
+    bool as_array) {
+  namespace py = boost::python;
+  const auto from = ExtractLocations(origins);
+  const auto to = ExtractLocations(destinations);
+  if (from.size() != to.size()) {
+    throw std::invalid_argument("origins and destinations must have the same length");
+  }
+  std::shared_ptr<const LaneGraph> graph;
+  std::vector<std::vector<LaneGraph::RouteStep>> routes(from.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    graph = LaneGraphCache::Get(self, resolution);
+    WorkerPool::Get().ParallelFor(routes.size(), 4u, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        routes[i] = PlanRouteSteps(self, *graph, from[i], to[i]);
+      }
+    });
+  }
+  py::list result;
+  for (auto &route : routes) {
+    if (!as_array) {
+      result.append(RouteToList(*graph, route));
+      continue;
+    }
+    const auto rows = static_cast<Py_ssize_t>(route.size());
+    uint32_t *nodes = nullptr;
+    int32_t *options = nullptr;
+    auto node_array = MakeNumPyArray("I", {rows}, nodes);
+    auto option_array = MakeNumPyArray("i", {rows}, options);
+    for (auto &step : route) {
+      *nodes++ = step.node;
+      *options++ = static_cast<int32_t>(step.option);
+    }
+    result.append(py::make_tuple(node_array, option_array));
+  }
+  return result;
+}
+
+template <>
+struct ArrayRowTraits<carla::SharedPtr<carla::client::Waypoint>> {
+  struct Row {
+    uint64_t id;
+    double s;
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    int32_t junction_id;
+    int32_t lane_type;
+    float x, y, z;
+    float pitch, yaw, roll;
+    bool is_junction;
+  };
+
+  static std::string GetFormat() {
+    return StructFormat()
+        .Field(offsetof(Row, id), "Q", sizeof(uint64_t), "id")
+        .Field(offsetof(Row, s), "d", sizeof(double), "s")
+        .Field(offsetof(Row, road_id), "I", sizeof(uint32_t), "road_id")
+        .Field(offsetof(Row, section_id), "I", sizeof(uint32_t), "section_id")
+        .Field(offsetof(Row, lane_id), "i", sizeof(int32_t), "lane_id")
+        .Field(offsetof(Row, junction_id), "i", sizeof(int32_t), "junction_id")
+        .Field(offsetof(Row, lane_type), "i", sizeof(int32_t), "lane_type")
+        .Field(offsetof(Row, x), "f", sizeof(float), "x")
+        .Field(offsetof(Row, y), "f", sizeof(float), "y")
+        .Field(offsetof(Row, z), "f", sizeof(float), "z")
+        .Field(offsetof(Row, pitch), "f", sizeof(float), "pitch")
+        .Field(offsetof(Row, yaw), "f", sizeof(float), "yaw")
+        .Field(offsetof(Row, roll), "f", sizeof(float), "roll")
+        .Field(offsetof(Row, is_junction), "?", sizeof(bool), "is_junction")
+        .Build(sizeof(Row));
+  }
+
+  static Row MakeRow(const carla::SharedPtr<carla::client::Waypoint> &waypoint) {
+    const auto transform = waypoint->GetTransform();
+    const auto &l = transform.location;
+    const auto &r = transform.rotation;
+    return {
+        waypoint->GetId(),
+        waypoint->GetDistance(),
+        waypoint->GetRoadId(),
+        waypoint->GetSectionId(),
+        waypoint->GetLaneId(),
+        waypoint->GetJunctionId(),
+        static_cast<int32_t>(waypoint->GetType()),
+        l.x, l.y, l.z,
+        r.pitch, r.yaw, r.roll,
+        waypoint->IsJunction()};
+  }
+};
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -145,6 +691,16 @@ void export_map() {
     .value("Curb", cre::LaneMarking::Type::Curb)
   ;
 
+  enum_<ERoadOption>("RoadOption")
+    .value("VOID", ERoadOption::Void)
+    .value("LEFT", ERoadOption::Left)
+    .value("RIGHT", ERoadOption::Right)
+    .value("STRAIGHT", ERoadOption::Straight)
+    .value("LANEFOLLOW", ERoadOption::LaneFollow)
+    .value("CHANGELANELEFT", ERoadOption::ChangeLaneLeft)
+    .value("CHANGELANERIGHT", ERoadOption::ChangeLaneRight)
+  ;
+
   enum_<cr::SignalOrientation>("LandmarkOrientation")
     .value("Positive", cr::SignalOrientation::Positive)
     .value("Negative", cr::SignalOrientation::Negative)
@@ -155,17 +711,36 @@ void export_map() {
   // ===========================================================================
 
   class_<cc::Map, boost::noncopyable, boost::shared_ptr<cc::Map>>("Map", no_init)
-    .def(init<std::string, std::string>((arg("name"), arg("xodr_content"))))
+    .def("__init__", make_constructor(&MakeMap, default_call_policies(), (arg("name"), arg("xodr_content"))))
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
-    .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
+    .def("get_spawn_points", CALL_RETURNING_ARRAY(cc::Map, GetRecommendedSpawnPoints), (arg("as_array")=false))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoint_handles", &GetWaypointHandles, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("next", +[](const cc::Map &self, const object &handles, double distance) {
+      return GetNextHandles(self, handles, distance, true);
+    }, (arg("handles"), arg("distance")))
+    .def("previous", +[](const cc::Map &self, const object &handles, double distance) {
+      return GetNextHandles(self, handles, distance, false);
+    }, (arg("handles"), arg("distance")))
+    .def("get_left_lane", +[](const cc::Map &self, const object &handles) {
+      return GetSideLaneHandles(self, handles, true);
+    }, (arg("handles")))
+    .def("get_right_lane", +[](const cc::Map &self, const object &handles) {
+      return GetSideLaneHandles(self, handles, false);
+    }, (arg("handles")))
+    .def("get_transforms", &GetHandleTransforms, (arg("handles")))
+    .def("to_waypoints", &HandlesToWaypoints, (arg("handles")))
     .def("get_topology", &GetTopology)
-    .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
+    .def("export_lane_graph", &ExportLaneGraph, (arg("resolution")=2.0))
+    .def("plan_route", &PlanRoute, (arg("origin"), arg("destination"), arg("resolution")=2.0))
+    .def("plan_routes", &PlanRoutes, (arg("origins"), arg("destinations"), arg("resolution")=2.0, arg("as_array")=false))
+    .def("generate_waypoints", CALL_RETURNING_ARRAY_1(cc::Map, GenerateWaypoints, double), (args("distance"), arg("as_array")=false))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
     .def("to_opendrive", CALL_RETURNING_COPY(cc::Map, GetOpenDrive))
     .def("save_to_disk", &SaveOpenDriveToDisk, (arg("path")=""))
-    .def("get_crosswalks", CALL_RETURNING_LIST(cc::Map, GetAllCrosswalkZones))
+    .def("get_crosswalks", CALL_RETURNING_ARRAY(cc::Map, GetAllCrosswalkZones), (arg("as_array")=false))
     .def("get_all_landmarks", CALL_RETURNING_LIST(cc::Map, GetAllLandmarks))
     .def("get_all_landmarks_from_id", CALL_RETURNING_LIST_1(cc::Map, GetLandmarksFromId, std::string), (args("opendrive_id")))
     .def("get_all_landmarks_of_type", CALL_RETURNING_LIST_1(cc::Map, GetAllLandmarksOfType, std::string), (args("type")))
@@ -185,8 +760,19 @@ void export_map() {
     .add_property("width", &cre::LaneMarking::width)
   ;
 
+  class_<cre::Waypoint>("WaypointHandle")
+    .def_readwrite("road_id", &cre::Waypoint::road_id)
+    .def_readwrite("section_id", &cre::Waypoint::section_id)
+    .def_readwrite("lane_id", &cre::Waypoint::lane_id)
+    .def_readwrite("s", &cre::Waypoint::s)
+    .def("__eq__", +[](const cre::Waypoint &self, const cre::Waypoint &other) { return self == other; })
+    .def("__ne__", +[](const cre::Waypoint &self, const cre::Waypoint &other) { return self != other; })
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<cc::Waypoint, boost::noncopyable, boost::shared_ptr<cc::Waypoint>>("Waypoint", no_init)
     .add_property("id", &cc::Waypoint::GetId)
+    .add_property("handle", &GetHandle)
     .add_property("transform", CALL_RETURNING_COPY(cc::Waypoint, GetTransform))
     .add_property("is_intersection", &cc::Waypoint::IsJunction) // deprecated
     .add_property("is_junction", &cc::Waypoint::IsJunction)
@@ -200,10 +786,10 @@ void export_map() {
     .add_property("lane_type", &cc::Waypoint::GetType)
     .add_property("right_lane_marking", CALL_RETURNING_OPTIONAL(cc::Waypoint, GetRightLaneMarking))
     .add_property("left_lane_marking", CALL_RETURNING_OPTIONAL(cc::Waypoint, GetLeftLaneMarking))
-    .def("next", CALL_RETURNING_LIST_1(cc::Waypoint, GetNext, double), (args("distance")))
-    .def("previous", CALL_RETURNING_LIST_1(cc::Waypoint, GetPrevious, double), (args("distance")))
-    .def("next_until_lane_end", CALL_RETURNING_LIST_1(cc::Waypoint, GetNextUntilLaneEnd, double), (args("distance")))
-    .def("previous_until_lane_start", CALL_RETURNING_LIST_1(cc::Waypoint, GetPreviousUntilLaneStart, double), (args("distance")))
+    .def("next", CALL_RETURNING_ARRAY_1(cc::Waypoint, GetNext, double), (args("distance"), arg("as_array")=false))
+    .def("previous", CALL_RETURNING_ARRAY_1(cc::Waypoint, GetPrevious, double), (args("distance"), arg("as_array")=false))
+    .def("next_until_lane_end", CALL_RETURNING_ARRAY_1(cc::Waypoint, GetNextUntilLaneEnd, double), (args("distance"), arg("as_array")=false))
+    .def("previous_until_lane_start", CALL_RETURNING_ARRAY_1(cc::Waypoint, GetPreviousUntilLaneStart, double), (args("distance"), arg("as_array")=false))
     .def("get_right_lane", &cc::Waypoint::GetRight)
     .def("get_left_lane", &cc::Waypoint::GetLeft)
     .def("get_junction", &cc::Waypoint::GetJunction)
@@ -281,4 +867,7 @@ void export_map() {
     .add_property("transform", CALL_RETURNING_COPY(cc::Landmark, GetTransform))
     .def("get_lane_validities", &GetLaneValidities)
   ;
+
+  def("set_map_cache_dir", &LaneGraphCache::SetDirectory, (arg("path")));
+  def("get_map_cache_dir", &LaneGraphCache::GetDirectory);
 }
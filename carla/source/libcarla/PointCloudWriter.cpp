@@ -0,0 +1,398 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/FileSystem.h>
+#include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/data/LidarMeasurement.h>
+#include <carla/sensor/data/SemanticLidarMeasurement.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// File formats of LidarMeasurement.save_to_disk.
+enum class EPointCloudFormat {
+  PlyAscii,
+  PlyBinary,
+  Pcd,
+  PcdCompressed,
+  KittiBin
+};
+
+/// Writers of the binary point cloud formats. Every field of the supported
+/// detections is 4 bytes wide, so points are packed as arrays of 32-bit
+/// words and always stored little-endian.
+namespace point_cloud_io {
+
+  struct Field {
+    /// Name used in PLY headers, matches the ASCII files of PointCloudIO.
+    const char *ply_name;
+    /// Name used in PCD headers.
+    const char *pcd_name;
+    /// Either 'F' (float32) or 'U' (uint32).
+    char type;
+  };
+
+  template <typename DetectionT>
+  struct PointTraits;
+
+  template <>
+  struct PointTraits<carla::sensor::data::LidarDetection> {
+    static constexpr size_t field_count = 4u;
+
+    static const std::array<Field, field_count> &GetFields() {
+      static const std::array<Field, field_count> fields = {{
+          {"x", "x", 'F'},
+          {"y", "y", 'F'},
+          {"z", "z", 'F'},
+          {"I", "intensity", 'F'}}};
+      return fields;
+    }
+  };
+
+  template <>
+  struct PointTraits<carla::sensor::data::SemanticLidarDetection> {
+    static constexpr size_t field_count = 6u;
+
+    static const std::array<Field, field_count> &GetFields() {
+      static const std::array<Field, field_count> fields = {{
+          {"x", "x", 'F'},
+          {"y", "y", 'F'},
+          {"z", "z", 'F'},
+          {"CosAngle", "cos_inc_angle", 'F'},
+          {"ObjIdx", "object_idx", 'U'},
+          {"ObjTag", "object_tag", 'U'}}};
+      return fields;
+    }
+  };
+
+  static inline uint32_t ToWord(float value) {
+    uint32_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    return word;
+  }
+
+  static inline void Pack(const carla::sensor::data::LidarDetection &point, uint32_t *words) {
+    words[0u] = ToWord(point.point.x);
+    words[1u] = ToWord(point.point.y);
+    words[2u] = ToWord(point.point.z);
+    words[3u] = ToWord(point.intensity);
+  }
+
+  static inline void Pack(const carla::sensor::data::SemanticLidarDetection &point, uint32_t *words) {
+    words[0u] = ToWord(point.point.x);
+    words[1u] = ToWord(point.point.y);
+    words[2u] = ToWord(point.point.z);
+    words[3u] = ToWord(point.cos_inc_angle);
+    words[4u] = point.object_idx;
+    words[5u] = point.object_tag;
+  }
+
+  static inline void StoreLittleEndian(uint32_t word, char *out) {
+    out[0u] = static_cast<char>(word & 0xffu);
+    out[1u] = static_cast<char>((word >> 8u) & 0xffu);
+    out[2u] = static_cast<char>((word >> 16u) & 0xffu);
+    out[3u] = static_cast<char>((word >> 24u) & 0xffu);
+  }
+
+  /// Buffers little-endian words and writes them to the stream in blocks.
+  class WordWriter {
+  public:
+
+    explicit WordWriter(std::ostream &out) : _out(out) {
+      _buffer.reserve(block_size);
+    }
+
+    ~WordWriter() {
+      Flush();
+    }
+
+    void Put(uint32_t word) {
+      char bytes[4u];
+      StoreLittleEndian(word, bytes);
+      _buffer.insert(_buffer.end(), bytes, bytes + 4u);
+      if (_buffer.size() >= block_size) {
+        Flush();
+      }
+    }
+
+    void Flush() {
+      _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+      _buffer.clear();
+    }
+
+  private:
+
+    static constexpr size_t block_size = 1u << 16u;
+
+    std::ostream &_out;
+
+    std::vector<char> _buffer;
+  };
+
+  /// LZF compression, as used by the binary_compressed PCD files. Produces
+  /// a stream decodable by any LZF decompressor: literal runs of up to 32
+  /// bytes and back references of 3 to 264 bytes within 8 KiB.
+  static std::vector<uint8_t> LzfCompress(const std::vector<uint8_t> &input) {
+    constexpr uint32_t hash_bits = 14u;
+    constexpr size_t max_literal = 32u;
+    constexpr size_t max_offset = 1u << 13u;
+    constexpr size_t max_match = 264u;
+    constexpr uint32_t none = ~0u;
+
+    const uint8_t *in = input.data();
+    const size_t size = input.size();
+    std::vector<uint32_t> table(size_t(1u) << hash_bits, none);
+    std::vector<uint8_t> out;
+    out.reserve(size + size / max_literal + 1u);
+
+    auto hash = [in](size_t i) {
+      const uint32_t value = (uint32_t(in[i]) << 16u) | (uint32_t(in[i + 1u]) << 8u) | in[i + 2u];
+      return (value * 2654435761u) >> (32u - hash_bits);
+    };
+
+    size_t literal = 0u;
+    auto flush_literals = [&](size_t end) {
+      while (literal < end) {
+        const size_t count = std::min(max_literal, end - literal);
+        out.push_back(static_cast<uint8_t>(count - 1u));
+        out.insert(out.end(), in + literal, in + literal + count);
+        literal += count;
+      }
+    };
+
+    size_t i = 0u;
+    while (i + 2u < size) {
+      const uint32_t key = hash(i);
+      const uint32_t candidate = table[key];
+      table[key] = static_cast<uint32_t>(i);
+      if ((candidate != none) &&
+          (i - candidate <= max_offset) &&
+          (std::memcmp(in + candidate, in + i, 3u) == 0)) {
+        const size_t limit = std::min(max_match, size - i);
+        size_t length = 3u;
+        while ((length < limit) && (in[candidate + length] == in[i + length])) {
+          ++length;
+        }
+        flush_literals(i);
+        const size_t offset = i - candidate - 1u;
+        const size_t encoded = length - 2u;
+        if (encoded < 7u) {
+          out.push_back(static_cast<uint8_t>((encoded << 5u) | (offset >> 8u)));
+        } else {
+          out.push_back(static_cast<uint8_t>((7u << 5u) | (offset >> 8u)));
+          out.push_back(static_cast<uint8_t>(encoded - 7u));
+        }
+        out.push_back(static_cast<uint8_t>(offset & 0xffu));
+        for (size_t j = i + 1u; (j < i + length) && (j + 2u < size); ++j) {
+          table[hash(j)] = static_cast<uint32_t>(j);
+        }
+        i += length;
+        literal = i;
+      } else {
+        ++i;
+      }
+    }
+    flush_literals(size);
+    return out;
+  }
+
+  template <typename DetectionT>
+  static void WritePlyHeader(std::ostream &out, size_t count) {
+    out << "ply\nformat binary_little_endian 1.0\nelement vertex " << count << '\n';
+    for (const auto &field : PointTraits<DetectionT>::GetFields()) {
+      out << "property " << (field.type == 'F' ? "float32 " : "uint32 ") << field.ply_name << '\n';
+    }
+    out << "end_header\n";
+  }
+
+  template <typename DetectionT>
+  static void WritePcdHeader(std::ostream &out, size_t count, const char *data) {
+    const auto &fields = PointTraits<DetectionT>::GetFields();
+    out << "# .PCD v0.7 - Point Cloud Data file format\nVERSION 0.7\nFIELDS";
+    for (const auto &field : fields) {
+      out << ' ' << field.pcd_name;
+    }
+    out << "\nSIZE";
+    for (size_t i = 0u; i < fields.size(); ++i) {
+      out << " 4";
+    }
+    out << "\nTYPE";
+    for (const auto &field : fields) {
+      out << ' ' << field.type;
+    }
+    out << "\nCOUNT";
+    for (size_t i = 0u; i < fields.size(); ++i) {
+      out << " 1";
+    }
+    out << "\nWIDTH " << count
+        << "\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS " << count
+        << "\nDATA " << data << '\n';
+  }
+
+  static std::ofstream OpenFile(const std::string &path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      throw std::runtime_error("failed to open file " + path);
+    }
+    return out;
+  }
+
+  static void CheckStream(const std::ostream &out, const std::string &path) {
+    if (!out) {
+      throw std::runtime_error("failed to write file " + path);
+    }
+  }
+
+  /// Writes the points in [begin, end) as interleaved little-endian words.
+  template <typename IteratorT>
+  static void WritePoints(std::ostream &out, IteratorT begin, IteratorT end) {
+    using DetectionT = typename std::iterator_traits<IteratorT>::value_type;
+    WordWriter writer(out);
+    uint32_t words[PointTraits<DetectionT>::field_count];
+    for (auto it = begin; it != end; ++it) {
+      Pack(*it, words);
+      for (auto word : words) {
+        writer.Put(word);
+      }
+    }
+  }
+
+  template <typename IteratorT>
+  static void WriteCompressedPoints(std::ostream &out, IteratorT begin, IteratorT end, size_t count) {
+    using DetectionT = typename std::iterator_traits<IteratorT>::value_type;
+    constexpr size_t field_count = PointTraits<DetectionT>::field_count;
+    // The compressed layout stores each field contiguously.
+    std::vector<uint8_t> fields(4u * field_count * count);
+    uint32_t words[field_count];
+    size_t index = 0u;
+    for (auto it = begin; it != end; ++it, ++index) {
+      Pack(*it, words);
+      for (size_t field = 0u; field < field_count; ++field) {
+        StoreLittleEndian(words[field], reinterpret_cast<char *>(&fields[4u * (field * count + index)]));
+      }
+    }
+    const auto compressed = LzfCompress(fields);
+    char sizes[8u];
+    StoreLittleEndian(static_cast<uint32_t>(compressed.size()), sizes);
+    StoreLittleEndian(static_cast<uint32_t>(fields.size()), sizes + 4u);
+    out.write(sizes, sizeof(sizes));
+    out.write(reinterpret_cast<const char *>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+  }
+
+  /// KITTI velodyne scans only store x, y, z, and a fourth float, the
+  /// intensity or the cosine of the incident angle.
+  template <typename IteratorT>
+  static void WriteKitti(std::ostream &out, IteratorT begin, IteratorT end) {
+    using DetectionT = typename std::iterator_traits<IteratorT>::value_type;
+    WordWriter writer(out);
+    uint32_t words[PointTraits<DetectionT>::field_count];
+    for (auto it = begin; it != end; ++it) {
+      Pack(*it, words);
+      for (size_t field = 0u; field < 4u; ++field) {
+        writer.Put(words[field]);
+      }
+    }
+  }
+
+  static std::string ReplaceExtension(const std::string &path, const std::string &extension) {
+    const auto slash = path.find_last_of("/\\");
+    const auto dot = path.find_last_of('.');
+    if ((dot == std::string::npos) || ((slash != std::string::npos) && (dot < slash))) {
+      return path + extension;
+    }
+    return path.substr(0u, dot) + extension;
+  }
+
+  /// Semantic tags are written next to the scan in a SemanticKITTI
+  /// ".label" file, with the tag in the lower 16 bits and the lower 16 bits
+  /// of the object index in the upper ones.
+  template <typename IteratorT>
+  static void WriteKittiLabelFile(const std::string &path, IteratorT begin, IteratorT end, std::true_type) {
+    auto out = OpenFile(path);
+    {
+      WordWriter writer(out);
+      for (auto it = begin; it != end; ++it) {
+        writer.Put((it->object_tag & 0xffffu) | (it->object_idx << 16u));
+      }
+    }
+    CheckStream(out, path);
+  }
+
+  template <typename IteratorT>
+  static void WriteKittiLabelFile(const std::string &, IteratorT, IteratorT, std::false_type) {}
+
+  /// Writes the points in [begin, end) to @a path in the given format and
+  /// returns the path written, with the extension of the format appended if
+  /// missing.
+  template <typename IteratorT>
+  static std::string WritePointCloud(std::string path, EPointCloudFormat format, IteratorT begin, IteratorT end) {
+    using DetectionT = typename std::iterator_traits<IteratorT>::value_type;
+    const size_t count = static_cast<size_t>(std::distance(begin, end));
+    switch (format) {
+      case EPointCloudFormat::PlyAscii:
+        return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), begin, end);
+      case EPointCloudFormat::PlyBinary: {
+        carla::FileSystem::ValidateFilePath(path, ".ply");
+        auto out = OpenFile(path);
+        WritePlyHeader<DetectionT>(out, count);
+        WritePoints(out, begin, end);
+        CheckStream(out, path);
+        return path;
+      }
+      case EPointCloudFormat::Pcd: {
+        carla::FileSystem::ValidateFilePath(path, ".pcd");
+        auto out = OpenFile(path);
+        WritePcdHeader<DetectionT>(out, count, "binary");
+        WritePoints(out, begin, end);
+        CheckStream(out, path);
+        return path;
+      }
+      case EPointCloudFormat::PcdCompressed: {
+        carla::FileSystem::ValidateFilePath(path, ".pcd");
+        auto out = OpenFile(path);
+        WritePcdHeader<DetectionT>(out, count, "binary_compressed");
+        WriteCompressedPoints(out, begin, end, count);
+        CheckStream(out, path);
+        return path;
+      }
+      case EPointCloudFormat::KittiBin: {
+        carla::FileSystem::ValidateFilePath(path, ".bin");
+        auto out = OpenFile(path);
+        WriteKitti(out, begin, end);
+        CheckStream(out, path);
+        WriteKittiLabelFile(
+            ReplaceExtension(path, ".label"),
+            begin,
+            end,
+            std::is_same<DetectionT, carla::sensor::data::SemanticLidarDetection>());
+        return path;
+      }
+      default:
+        throw std::invalid_argument("invalid point cloud format!");
+    }
+  }
+
+} // namespace point_cloud_io
+
+void export_point_cloud_writer() {
+  using namespace boost::python;
+
+  enum_<EPointCloudFormat>("PointCloudFormat")
+    .value("PlyAscii", EPointCloudFormat::PlyAscii)
+    .value("PlyBinary", EPointCloudFormat::PlyBinary)
+    .value("Pcd", EPointCloudFormat::Pcd)
+    .value("PcdCompressed", EPointCloudFormat::PcdCompressed)
+    .value("KittiBin", EPointCloudFormat::KittiBin)
+  ;
+}
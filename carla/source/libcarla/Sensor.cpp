@@ -10,8 +10,36 @@
 #include <carla/client/Sensor.h>
 #include <carla/client/ServerSideSensor.h>
 
+#include <boost/make_shared.hpp>
+
 static void SubscribeToStream(carla::client::Sensor &self, boost::python::object callback) {
   self.Listen(MakeCallback(std::move(callback)));
+  SensorQueueRegistry::Get().Close(self.GetId());
+}
+
+static boost::shared_ptr<SensorQueue> SubscribeToQueue(
+    carla::client::Sensor &self,
+    size_t max_size,
+    ESensorQueuePolicy policy) {
+  auto queue = boost::make_shared<SensorQueue>(max_size, policy);
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.Listen([queue](auto message) { queue->Push(std::move(message)); });
+  SensorQueueRegistry::Get().Register(self.GetId(), queue);
+  return queue;
+}
+
+/// Stops the sensor and wakes up the threads waiting on its queue.
+static void StopSensor(carla::client::Sensor &self) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.Stop();
+  SensorQueueRegistry::Get().Close(self.GetId());
+}
+
+static bool DestroySensor(carla::client::Sensor &self) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  const bool result = self.Destroy();
+  SensorQueueRegistry::Get().Close(self.GetId());
+  return result;
 }
 
 static void SubscribeToGBuffer(
@@ -28,8 +56,10 @@ void export_sensor() {
   class_<cc::Sensor, bases<cc::Actor>, boost::noncopyable, boost::shared_ptr<cc::Sensor>>("Sensor", no_init)
     .add_property("is_listening", &cc::Sensor::IsListening)
     .def("listen", &SubscribeToStream, (arg("callback")))
+    .def("listen_queue", &SubscribeToQueue, (arg("maxsize")=8u, arg("policy")=ESensorQueuePolicy::DropOldest))
     .def("is_listening", &cc::Sensor::IsListening)
-    .def("stop", &cc::Sensor::Stop)
+    .def("stop", &StopSensor)
+    .def("destroy", &DestroySensor)
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -5,10 +5,7 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <carla/PythonUtil.h>
-#include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
-#include <carla/image/ImageView.h>
-#include <carla/pointcloud/PointCloudIO.h>
 #include <carla/sensor/SensorData.h>
 #include <carla/sensor/data/CollisionEvent.h>
 #include <carla/sensor/data/IMUMeasurement.h>
@@ -23,14 +20,17 @@
 
 #include <carla/sensor/data/RadarData.h>
 
-#include <boost/python/suite/indexing/vector_indexing_suite.hpp>
+#include <boost/make_shared.hpp>
 
 #include <ostream>
 #include <iostream>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
 #include <vector>
 #include <algorithm>
-#include <thread>
 
 namespace carla {
 namespace sensor {
@@ -178,182 +178,440 @@ enum class EColorConverter {
 };
 
 template <typename T>
-static auto GetRawDataAsBuffer(T &self) {
-  auto *data = reinterpret_cast<unsigned char *>(self.data());
-  auto size = static_cast<Py_ssize_t>(sizeof(typename T::value_type) * self.size());
+static boost::python::object GetRawDataAsBuffer(boost::python::object self) {
+  T &data = boost::python::extract<T &>(self);
 #if PY_MAJOR_VERSION >= 3
-  auto *ptr = PyMemoryView_FromMemory(reinterpret_cast<char *>(data), size, PyBUF_READ);
+  BufferLayout layout;
+  layout.data = data.data();
+  layout.format = "B";
+  layout.itemsize = 1;
+  layout.shape = {static_cast<Py_ssize_t>(sizeof(typename T::value_type) * data.size())};
+  layout.readonly = true;
+  return MakeMemoryView(std::move(self), std::move(layout));
 #else
-  auto *ptr = PyBuffer_FromMemory(data, size);
-#endif
+  auto *ptr = PyBuffer_FromMemory(
+      reinterpret_cast<unsigned char *>(data.data()),
+      static_cast<Py_ssize_t>(sizeof(typename T::value_type) * data.size()));
   return boost::python::object(boost::python::handle<>(ptr));
+#endif
 }
 
-template <typename T>
-static void ConvertImage(T &self, EColorConverter cc) {
-  carla::PythonUtil::ReleaseGIL unlock;
-  using namespace carla::image;
-  auto view = ImageView::MakeView(self);
+/// Returns the vectorized kernel implementing @a cc, or nullptr for Raw.
+static image_kernels::Kernel GetColorKernel(EColorConverter cc) {
+  const auto &kernels = image_kernels::GetColorKernels();
   switch (cc) {
+    case EColorConverter::Raw:
+      return nullptr;
     case EColorConverter::Depth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::Depth());
-      break;
+      return kernels.depth;
     case EColorConverter::LogarithmicDepth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::LogarithmicDepth());
-      break;
+      return kernels.logarithmic_depth;
     case EColorConverter::CityScapesPalette:
-      ImageConverter::ConvertInPlace(view, ColorConverter::CityScapesPalette());
-      break;
-    case EColorConverter::Raw:
-      break; // ignore.
+      return kernels.cityscapes_palette;
     default:
       throw std::invalid_argument("invalid color converter!");
   }
 }
 
-// image object resturned from optical flow to color conversion
-class FakeImage : public std::vector<uint8_t> {
-  public:
-  unsigned int Width = 0;
-  unsigned int Height = 0;
-  float FOV = 0;
+template <typename T>
+static void ConvertImage(T &self, EColorConverter cc) {
+  static_assert(sizeof(typename T::value_type) == sizeof(uint32_t), "Invalid pixel size.");
+  const auto kernel = GetColorKernel(cc);
+  carla::PythonUtil::ReleaseGIL unlock;
+  if (kernel != nullptr) {
+    auto *data = reinterpret_cast<uint32_t *>(self.data());
+    kernel(data, data, self.size());
+  }
+}
+
+// BGRA image returned from the optical flow to color conversion, fakes the
+// regular image object.
+class FakeImage {
+public:
+
+  using value_type = carla::sensor::data::Color;
+
+  FakeImage(size_t width, size_t height, float fov)
+    : _width(width),
+      _height(height),
+      _fov(fov),
+      _pixels(width * height) {}
+
+  size_t GetWidth() const {
+    return _width;
+  }
+
+  size_t GetHeight() const {
+    return _height;
+  }
+
+  float GetFOVAngle() const {
+    return _fov;
+  }
+
+  value_type *data() {
+    return _pixels.data();
+  }
+
+  size_t size() const {
+    return _pixels.size();
+  }
+
+  value_type &at(size_t pos) {
+    return _pixels.at(pos);
+  }
+
+  auto begin() {
+    return _pixels.begin();
+  }
+
+  auto end() {
+    return _pixels.end();
+  }
+
+private:
+
+  size_t _width;
+
+  size_t _height;
+
+  float _fov;
+
+  std::vector<value_type> _pixels;
+};
+
+template <typename T>
+static BufferLayout MakeImageBufferLayout(T &self, const char *format, size_t itemsize, Py_ssize_t channels) {
+  BufferLayout layout;
+  layout.data = self.data();
+  layout.format = format;
+  layout.itemsize = static_cast<Py_ssize_t>(itemsize);
+  layout.shape = {
+      static_cast<Py_ssize_t>(self.GetHeight()),
+      static_cast<Py_ssize_t>(self.GetWidth()),
+      channels};
+  return layout;
+}
+
+template <typename T>
+static BufferLayout MakeArrayBufferLayout(T &self, std::string format, size_t itemsize) {
+  BufferLayout layout;
+  layout.data = self.data();
+  layout.format = std::move(format);
+  layout.itemsize = static_cast<Py_ssize_t>(itemsize);
+  layout.shape = {static_cast<Py_ssize_t>(self.size())};
+  const auto fields = sizeof(typename T::value_type) / itemsize;
+  if (fields > 1u) {
+    layout.shape.emplace_back(static_cast<Py_ssize_t>(fields));
+  }
+  return layout;
+}
+
+template <>
+struct BufferTraits<carla::sensor::data::Image> {
+  static BufferLayout Describe(carla::sensor::data::Image &self) {
+    static_assert(sizeof(carla::sensor::data::Color) == 4u, "unexpected color layout");
+    return MakeImageBufferLayout(self, "B", sizeof(uint8_t), 4);
+  }
 };
-// method to convert optical flow images to rgb
-static FakeImage ColorCodedFlow (
-    carla::sensor::data::OpticalFlowImage& image) {
-  namespace bp = boost::python;
-  namespace csd = carla::sensor::data;
-  constexpr float pi = 3.1415f;
-  constexpr float rad2ang = 360.f/(2.f*pi);
-  FakeImage result;
-  result.Width = image.GetWidth();
-  result.Height = image.GetHeight();
-  result.FOV = image.GetFOVAngle();
-  result.resize(image.GetHeight()*image.GetWidth()* 4);
-
-  // lambda for computing batches of pixels
-  auto command = [&] (size_t min_index, size_t max_index) {
-    for (size_t index = min_index; index < max_index; index++) {
-      const csd::OpticalFlowPixel& pixel = image[index];
-      float vx = pixel.x;
-      float vy = pixel.y;
-
-      float angle = 180.f + std::atan2(vy, vx)*rad2ang;
-      if (angle < 0) angle = 360.f + angle;
-      angle = std::fmod(angle, 360.f);
-
-      float norm = std::sqrt(vx*vx + vy*vy);
-      const float shift = 0.999f;
-      const float a = 1.f/std::log(0.1f + shift);
-      float intensity = carla::geom::Math::Clamp(a*std::log(norm + shift), 0.f, 1.f);
-
-      float& H = angle;
-      float  S = 1.f;
-      float V = intensity;
-      float H_60 = H*(1.f/60.f);
-
-      float C = V * S;
-      float X = C*(1.f - std::abs(std::fmod(H_60, 2.f) - 1.f));
-      float m = V - C;
-
-      float r = 0,g = 0,b = 0;
-      unsigned int angle_case = static_cast<unsigned int>(H_60);
-      switch (angle_case) {
-      case 0:
-        r = C;
-        g = X;
-        b = 0;
-        break;
-      case 1:
-        r = X;
-        g = C;
-        b = 0;
-        break;
-      case 2:
-        r = 0;
-        g = C;
-        b = X;
-        break;
-      case 3:
-        r = 0;
-        g = X;
-        b = C;
-        break;
-      case 4:
-        r = X;
-        g = 0;
-        b = C;
-        break;
-      case 5:
-        r = C;
-        g = 0;
-        b = X;
-        break;
-      default:
-        r = 1;
-        g = 1;
-        b = 1;
-        break;
-      }
-
-      uint8_t R = static_cast<uint8_t>((r+m)*255.f);
-      uint8_t G = static_cast<uint8_t>((g+m)*255.f);
-      uint8_t B = static_cast<uint8_t>((b+m)*255.f);
-      result[4*index] = B;
-      result[4*index + 1] = G;
-      result[4*index + 2] = R;
-      result[4*index + 3] = 0;
+
+template <>
+struct BufferTraits<carla::sensor::data::OpticalFlowImage> {
+  static BufferLayout Describe(carla::sensor::data::OpticalFlowImage &self) {
+    static_assert(sizeof(carla::sensor::data::OpticalFlowPixel) == 2u * sizeof(float), "unexpected pixel layout");
+    return MakeImageBufferLayout(self, "f", sizeof(float), 2);
+  }
+};
+
+template <>
+struct BufferTraits<FakeImage> {
+  static BufferLayout Describe(FakeImage &self) {
+    return MakeImageBufferLayout(self, "B", sizeof(uint8_t), 4);
+  }
+};
+
+template <>
+struct BufferTraits<carla::sensor::data::LidarMeasurement> {
+  static BufferLayout Describe(carla::sensor::data::LidarMeasurement &self) {
+    static_assert(sizeof(carla::sensor::data::LidarDetection) == 4u * sizeof(float), "unexpected detection layout");
+    return MakeArrayBufferLayout(self, "f", sizeof(float));
+  }
+};
+
+template <>
+struct BufferTraits<carla::sensor::data::SemanticLidarMeasurement> {
+  static BufferLayout Describe(carla::sensor::data::SemanticLidarMeasurement &self) {
+    using Detection = carla::sensor::data::SemanticLidarDetection;
+    static_assert(sizeof(carla::geom::Location) == 3u * sizeof(float), "unexpected point layout");
+    static const std::string format = StructFormat()
+        .Field(offsetof(Detection, point), "f", sizeof(float), "x")
+        .Field(offsetof(Detection, point) + sizeof(float), "f", sizeof(float), "y")
+        .Field(offsetof(Detection, point) + 2u * sizeof(float), "f", sizeof(float), "z")
+        .Field(offsetof(Detection, cos_inc_angle), "f", sizeof(float), "cos_inc_angle")
+        .Field(offsetof(Detection, object_idx), "I", sizeof(uint32_t), "object_idx")
+        .Field(offsetof(Detection, object_tag), "I", sizeof(uint32_t), "object_tag")
+        .Build(sizeof(Detection));
+    return MakeArrayBufferLayout(self, format, sizeof(Detection));
+  }
+};
+
+template <>
+struct BufferTraits<carla::sensor::data::RadarMeasurement> {
+  static BufferLayout Describe(carla::sensor::data::RadarMeasurement &self) {
+    using Detection = carla::sensor::data::RadarDetection;
+    static const std::string format = StructFormat()
+        .Field(offsetof(Detection, velocity), "f", sizeof(float), "velocity")
+        .Field(offsetof(Detection, azimuth), "f", sizeof(float), "azimuth")
+        .Field(offsetof(Detection, altitude), "f", sizeof(float), "altitude")
+        .Field(offsetof(Detection, depth), "f", sizeof(float), "depth")
+        .Build(sizeof(Detection));
+    return MakeArrayBufferLayout(self, format, sizeof(Detection));
+  }
+};
+
+static const std::string &GetDVSEventFormat() {
+  using Event = carla::sensor::data::DVSEvent;
+  static const std::string format = StructFormat()
+      .Field(offsetof(Event, x), "H", sizeof(uint16_t), "x")
+      .Field(offsetof(Event, y), "H", sizeof(uint16_t), "y")
+      .Field(offsetof(Event, t), "q", sizeof(int64_t), "t")
+      .Field(offsetof(Event, pol), "?", sizeof(bool), "pol")
+      .Build(sizeof(Event));
+  return format;
+}
+
+template <>
+struct BufferTraits<carla::sensor::data::DVSEventArray> {
+  static BufferLayout Describe(carla::sensor::data::DVSEventArray &self) {
+    return MakeArrayBufferLayout(self, GetDVSEventFormat(), sizeof(carla::sensor::data::DVSEvent));
+  }
+};
+
+// -- DVS event arrays ---------------------------------------------------------
+
+/// Returns a new array with the value of @a field for each event.
+template <typename T, typename FunctorT>
+static boost::python::object GetDVSEventField(
+    const carla::sensor::data::DVSEventArray &self,
+    const char *format,
+    FunctorT &&field) {
+  T *data = nullptr;
+  auto result = MakeNumPyArray(format, {static_cast<Py_ssize_t>(self.size())}, data);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    for (const auto &event : self) {
+      *data++ = field(event);
+    }
+  }
+  return result;
+}
+
+/// Returns a new N x 4 array of int64 with [x, y, t, pol] for each event,
+/// with the polarity as -1 or +1.
+static boost::python::object DVSEventsToArray(const carla::sensor::data::DVSEventArray &self) {
+  int64_t *data = nullptr;
+  auto result = MakeNumPyArray("q", {static_cast<Py_ssize_t>(self.size()), 4}, data);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    for (const auto &event : self) {
+      *data++ = event.x;
+      *data++ = event.y;
+      *data++ = event.t;
+      *data++ = event.pol ? 1 : -1;
+    }
+  }
+  return result;
+}
+
+/// Event arrays of a Python sequence, the sequence keeps them alive.
+static std::vector<const carla::sensor::data::DVSEventArray *> ExtractDVSEventArrays(
+    const boost::python::object &sequence) {
+  namespace py = boost::python;
+  std::vector<const carla::sensor::data::DVSEventArray *> result;
+  const auto size = py::len(sequence);
+  result.reserve(static_cast<size_t>(size));
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    const carla::sensor::data::DVSEventArray &events = py::extract<const carla::sensor::data::DVSEventArray &>(sequence[i]);
+    result.emplace_back(&events);
+  }
+  return result;
+}
+
+/// Draws @a events over an (H * W) x 3 RGB image, blue for positive events and
+/// red for negative ones.
+static void DrawDVSEvents(const carla::sensor::data::DVSEventArray &events, uint8_t *image) {
+  const size_t width = events.GetWidth();
+  const size_t height = events.GetHeight();
+  for (const auto &event : events) {
+    if ((event.x < width) && (event.y < height)) {
+      image[3u * (width * event.y + event.x) + (event.pol ? 2u : 0u)] = 255u;
+    }
+  }
+}
+
+/// Draws every event of @a arrays on @a out, a writable buffer of
+/// height * width * 3 bytes, or on a new black image if @a out is None.
+static boost::python::object AccumulateDVSEvents(
+    const std::vector<const carla::sensor::data::DVSEventArray *> &arrays,
+    boost::python::object out) {
+  namespace py = boost::python;
+  if (arrays.empty()) {
+    throw std::invalid_argument("no event arrays to accumulate");
+  }
+  const size_t width = arrays.front()->GetWidth();
+  const size_t height = arrays.front()->GetHeight();
+  for (const auto *events : arrays) {
+    if ((events->GetWidth() != width) || (events->GetHeight() != height)) {
+      throw std::invalid_argument("event arrays have different dimensions");
+    }
+  }
+  auto draw = [&](uint8_t *image) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    for (const auto *events : arrays) {
+      DrawDVSEvents(*events, image);
     }
   };
-  size_t num_threads = std::max(8u, std::thread::hardware_concurrency());
-  size_t batch_size = image.size() / num_threads;
-  std::vector<std::thread*> t(num_threads+1);
+  if (out.is_none()) {
+    uint8_t *data = nullptr;
+    auto result = MakeNumPyArray("B", {static_cast<Py_ssize_t>(height * width), 3}, data);
+    std::memset(data, 0, 3u * width * height);
+    draw(data);
+    return result;
+  }
+  ScopedBuffer buffer(out, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS);
+  if (buffer.size() != 3u * width * height) {
+    throw std::invalid_argument(
+        "output buffer size mismatch: expected " +
+        std::to_string(3u * width * height) + " bytes, got " +
+        std::to_string(buffer.size()));
+  }
+  draw(static_cast<uint8_t *>(buffer.data()));
+  return out;
+}
 
-  for(size_t n = 0; n < num_threads; n++) {
-    t[n] = new std::thread(command, n * batch_size, (n+1) * batch_size);
+/// Concatenates the events of @a sequence in a new structured array.
+static boost::python::object MergeDVSEvents(const boost::python::object &sequence) {
+  using Event = carla::sensor::data::DVSEvent;
+  const auto arrays = ExtractDVSEventArrays(sequence);
+  size_t count = 0u;
+  for (const auto *events : arrays) {
+    count += events->size();
+  }
+  BufferLayout layout;
+  layout.format = GetDVSEventFormat();
+  layout.itemsize = static_cast<Py_ssize_t>(sizeof(Event));
+  layout.shape = {static_cast<Py_ssize_t>(count)};
+  auto array = MakeArray(layout);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    auto *data = static_cast<Event *>(layout.data);
+    for (const auto *events : arrays) {
+      data = std::copy(events->begin(), events->end(), data);
+    }
   }
-  t[num_threads] = new std::thread(command, num_threads * batch_size, image.size());
+  return AsNumPyArray(array);
+}
+
+/// Writes the color-coded optical flow of @a image into @a pixels, which must
+/// hold one BGRA pixel per flow vector.
+static void ColorCodeFlow(const carla::sensor::data::OpticalFlowImage &image, uint32_t *pixels) {
+  static_assert(sizeof(carla::sensor::data::OpticalFlowPixel) == 2u * sizeof(float), "unexpected pixel layout");
+  const auto kernel = image_kernels::GetColorKernels().optical_flow;
+  const auto *flow = reinterpret_cast<const float *>(image.data());
+  WorkerPool::Get().ParallelFor(image.size(), 16384u, [&](size_t begin, size_t end) {
+    kernel(flow + 2u * begin, pixels + begin, end - begin);
+  });
+}
 
-  for(size_t n = 0; n <= num_threads; n++) {
-    if(t[n]->joinable()){
-      t[n]->join();
+// method to convert optical flow images to rgb, if a writable buffer is given
+// as @a out the result is written there instead of into a new image.
+static boost::python::object ColorCodedFlow(
+    carla::sensor::data::OpticalFlowImage &image,
+    boost::python::object out) {
+  namespace py = boost::python;
+  if (out.is_none()) {
+    auto result = boost::make_shared<FakeImage>(image.GetWidth(), image.GetHeight(), image.GetFOVAngle());
+    {
+      carla::PythonUtil::ReleaseGIL unlock;
+      ColorCodeFlow(image, reinterpret_cast<uint32_t *>(result->data()));
     }
-    delete t[n];
+    return py::object(result);
   }
-  return result;
+  ScopedBuffer buffer(out, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS);
+  if (buffer.size() != image.size() * sizeof(uint32_t)) {
+    throw std::invalid_argument(
+        "output buffer size mismatch: expected " +
+        std::to_string(image.size() * sizeof(uint32_t)) + " bytes, got " +
+        std::to_string(buffer.size()));
+  }
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    ColorCodeFlow(image, static_cast<uint32_t *>(buffer.data()));
+  }
+  return out;
+}
+
+/// Writes a BGRA image, converting it first with @a kernel if not null.
+static std::string WriteImageToDisk(
+    std::string path,
+    const uint32_t *pixels,
+    size_t width,
+    size_t height,
+    image_kernels::Kernel kernel) {
+  // Convert into a temporary buffer so the image itself is left untouched.
+  std::vector<uint32_t> converted;
+  if (kernel != nullptr) {
+    converted.resize(width * height);
+    kernel(pixels, converted.data(), converted.size());
+    pixels = converted.data();
+  }
+  const auto columns = static_cast<std::ptrdiff_t>(width);
+  return carla::image::ImageIO::WriteView(
+      std::move(path),
+      boost::gil::interleaved_view(
+          columns,
+          static_cast<std::ptrdiff_t>(height),
+          reinterpret_cast<const boost::gil::bgra8_pixel_t *>(pixels),
+          columns * static_cast<std::ptrdiff_t>(sizeof(uint32_t))));
 }
 
 template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
-  carla::PythonUtil::ReleaseGIL unlock;
-  using namespace carla::image;
-  auto view = ImageView::MakeView(self);
-  switch (cc) {
-    case EColorConverter::Raw:
-      return ImageIO::WriteView(
-          std::move(path),
-          view);
-    case EColorConverter::Depth:
-      return ImageIO::WriteView(
-          std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()));
-    case EColorConverter::LogarithmicDepth:
-      return ImageIO::WriteView(
-          std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()));
-    case EColorConverter::CityScapesPalette:
-      return ImageIO::WriteView(
-          std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()));
-    default:
-      throw std::invalid_argument("invalid color converter!");
+static boost::python::object SaveImageToDisk(T &self, std::string path, EColorConverter cc, bool asynchronous) {
+  static_assert(sizeof(typename T::value_type) == sizeof(uint32_t), "Invalid pixel size.");
+  const auto kernel = GetColorKernel(cc);
+  const auto *pixels = reinterpret_cast<const uint32_t *>(self.data());
+  const size_t width = self.GetWidth();
+  const size_t height = self.GetHeight();
+  if (asynchronous) {
+    // Copy the pixels, the image may be modified or released before the
+    // writer gets to it.
+    auto copy = std::make_shared<std::vector<uint32_t>>(pixels, pixels + self.size());
+    return SubmitToDiskWriter(path, [=]() {
+      return WriteImageToDisk(path, copy->data(), width, height, kernel);
+    });
   }
+  std::string result;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    result = WriteImageToDisk(std::move(path), pixels, width, height, kernel);
+  }
+  return boost::python::object(result);
 }
 
 template <typename T>
-static std::string SavePointCloudToDisk(T &self, std::string path) {
-  carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+static boost::python::object SavePointCloudToDisk(T &self, std::string path, EPointCloudFormat format, bool asynchronous) {
+  if (asynchronous) {
+    auto copy = std::make_shared<std::vector<typename T::value_type>>(self.begin(), self.end());
+    return SubmitToDiskWriter(path, [=]() {
+      return point_cloud_io::WritePointCloud(path, format, copy->begin(), copy->end());
+    });
+  }
+  std::string result;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    result = point_cloud_io::WritePointCloud(std::move(path), format, self.begin(), self.end());
+  }
+  return boost::python::object(result);
 }
 
 void export_sensor_data() {
@@ -366,12 +624,22 @@ void export_sensor_data() {
 
   // Fake image returned from optical flow to color conversion
   // fakes the regular image object. Only used for visual purposes
-  class_<FakeImage>("FakeImage", no_init)
-      .def(vector_indexing_suite<std::vector<uint8_t>>())
-      .add_property("width", &FakeImage::Width)
-      .add_property("height", &FakeImage::Height)
-      .add_property("fov", &FakeImage::FOV)
-      .add_property("raw_data", &GetRawDataAsBuffer<FakeImage>);
+  class_<FakeImage, boost::noncopyable, boost::shared_ptr<FakeImage>>("FakeImage", no_init)
+    .add_property("width", &FakeImage::GetWidth)
+    .add_property("height", &FakeImage::GetHeight)
+    .add_property("fov", &FakeImage::GetFOVAngle)
+    .add_property("raw_data", &GetRawDataAsBuffer<FakeImage>)
+    .def(BufferProtocol())
+    .def("save_to_disk", &SaveImageToDisk<FakeImage>, (arg("path"), arg("color_converter")=EColorConverter::Raw, arg("asynchronous")=false))
+    .def("__len__", &FakeImage::size)
+    .def("__iter__", iterator<FakeImage>())
+    .def("__getitem__", +[](FakeImage &self, size_t pos) -> csd::Color {
+      return self.at(pos);
+    })
+    .def("__setitem__", +[](FakeImage &self, size_t pos, csd::Color color) {
+      self.at(pos) = color;
+    })
+  ;
 
   class_<cs::SensorData, boost::noncopyable, boost::shared_ptr<cs::SensorData>>("SensorData", no_init)
     .add_property("frame", &cs::SensorData::GetFrame)
@@ -410,8 +678,9 @@ void export_sensor_data() {
     .add_property("height", &csd::Image::GetHeight)
     .add_property("fov", &csd::Image::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::Image>)
+    .def(BufferProtocol())
     .def("convert", &ConvertImage<csd::Image>, (arg("color_converter")))
-    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw))
+    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw, arg("asynchronous")=false))
     .def("__len__", &csd::Image::size)
     .def("__iter__", iterator<csd::Image>())
     .def("__getitem__", +[](const csd::Image &self, size_t pos) -> csd::Color {
@@ -428,7 +697,8 @@ void export_sensor_data() {
     .add_property("height", &csd::OpticalFlowImage::GetHeight)
     .add_property("fov", &csd::OpticalFlowImage::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::OpticalFlowImage>)
-    .def("get_color_coded_flow", &ColorCodedFlow)
+    .def(BufferProtocol())
+    .def("get_color_coded_flow", &ColorCodedFlow, (arg("out")=object()))
     .def("__len__", &csd::OpticalFlowImage::size)
     .def("__iter__", iterator<csd::OpticalFlowImage>())
     .def("__getitem__", +[](const csd::OpticalFlowImage &self, size_t pos) -> csd::OpticalFlowPixel {
@@ -444,8 +714,9 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
+    .def(BufferProtocol())
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("format")=EPointCloudFormat::PlyAscii, arg("asynchronous")=false))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -461,8 +732,9 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::SemanticLidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
+    .def(BufferProtocol())
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("format")=EPointCloudFormat::PlyAscii, arg("asynchronous")=false))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
@@ -510,6 +782,7 @@ void export_sensor_data() {
 
   class_<csd::RadarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::RadarMeasurement>>("RadarMeasurement", no_init)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::RadarMeasurement>)
+    .def(BufferProtocol())
     .def("get_detection_count", &csd::RadarMeasurement::GetDetectionAmount)
     .def("__len__", &csd::RadarMeasurement::size)
     .def("__iter__", iterator<csd::RadarMeasurement>())
@@ -557,6 +830,7 @@ void export_sensor_data() {
     .add_property("height", &csd::DVSEventArray::GetHeight)
     .add_property("fov", &csd::DVSEventArray::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::DVSEventArray>)
+    .def(BufferProtocol())
     .def("__len__", &csd::DVSEventArray::size)
     .def("__iter__", iterator<csd::DVSEventArray>())
     .def("__getitem__", +[](const csd::DVSEventArray &self, size_t pos) -> csd::DVSEvent {
@@ -565,12 +839,30 @@ void export_sensor_data() {
     .def("__setitem__", +[](csd::DVSEventArray &self, size_t pos, csd::DVSEvent event) {
       self.at(pos) = event;
     })
-    .def("to_image", CALL_RETURNING_LIST(csd::DVSEventArray, ToImage))
-    .def("to_array", CALL_RETURNING_LIST(csd::DVSEventArray, ToArray))
-    .def("to_array_x", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayX))
-    .def("to_array_y", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayY))
-    .def("to_array_t", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayT))
-    .def("to_array_pol", CALL_RETURNING_LIST(csd::DVSEventArray, ToArrayPol))
+    .def("to_image", +[](const csd::DVSEventArray &self, object out) {
+      return AccumulateDVSEvents({&self}, out);
+    }, (arg("out")=object()))
+    .def("to_array", &DVSEventsToArray)
+    .def("to_array_x", +[](const csd::DVSEventArray &self) {
+      return GetDVSEventField<uint16_t>(self, "H", [](const csd::DVSEvent &event) { return event.x; });
+    })
+    .def("to_array_y", +[](const csd::DVSEventArray &self) {
+      return GetDVSEventField<uint16_t>(self, "H", [](const csd::DVSEvent &event) { return event.y; });
+    })
+    .def("to_array_t", +[](const csd::DVSEventArray &self) {
+      return GetDVSEventField<int64_t>(self, "q", [](const csd::DVSEvent &event) { return event.t; });
+    })
+    .def("to_array_pol", +[](const csd::DVSEventArray &self) {
+      return GetDVSEventField<int16_t>(self, "h", [](const csd::DVSEvent &event) {
+        return static_cast<int16_t>(event.pol ? 1 : -1);
+      });
+    })
+    .def("accumulate", +[](const object &event_arrays, object out) {
+      return AccumulateDVSEvents(ExtractDVSEventArrays(event_arrays), out);
+    }, (arg("event_arrays"), arg("out")=object()))
+    .staticmethod("accumulate")
+    .def("merge", &MergeDVSEvents, (arg("event_arrays")))
+    .staticmethod("merge")
     .def(self_ns::str(self_ns::self))
   ;
 }
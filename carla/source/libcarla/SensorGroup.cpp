@@ -0,0 +1,402 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/PythonUtil.h>
+#include <carla/client/Sensor.h>
+#include <carla/sensor/SensorData.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/// What to do with a frame that is missing the measurement of some sensor
+/// when it expires.
+enum class EIncompleteFramePolicy {
+  Drop,
+  Deliver
+};
+
+/// Counters of a SensorGroup since it was created.
+struct SensorGroupStats {
+  size_t delivered = 0u;
+  size_t incomplete = 0u;
+  size_t dropped = 0u;
+  size_t late = 0u;
+};
+
+/// Aligns the measurements of several sensors by frame number.
+///
+/// Measurements are kept in a bounded window of pending frames sorted by
+/// frame. Each sensor stream arrives in order, so once a frame is complete
+/// the older pending frames can no longer complete and expire. Pending
+/// frames also expire when they are older than the timeout or when the
+/// window is full.
+///
+/// Frames may be released from the thread of any sensor. Each group of
+/// released frames takes a ticket, and groups are delivered one at a time
+/// in ticket order, so the callback sees the frames in order even if the
+/// releasing threads wait for the GIL in a different order. A group
+/// released from inside a delivery, e.g. by stopping the group from its
+/// callback, cannot wait for its turn on that thread; it is queued and
+/// delivered when the turns before it end.
+class FrameSynchronizer : private boost::noncopyable {
+public:
+
+  using DataPtr = carla::SharedPtr<carla::sensor::SensorData>;
+
+  struct Frame {
+    size_t frame;
+    /// One per sensor, null if the sensor did not deliver this frame.
+    std::vector<DataPtr> data;
+  };
+
+  using DeliverFunction = std::function<void(const std::vector<Frame> &)>;
+
+  FrameSynchronizer(size_t sensor_count, size_t capacity, double timeout, EIncompleteFramePolicy policy)
+    : _sensor_count(sensor_count),
+      _capacity(capacity),
+      _timeout(timeout),
+      _policy(policy) {
+    if (sensor_count == 0u || capacity == 0u) {
+      throw std::invalid_argument("sensor group needs at least one sensor and a capacity of one frame");
+    }
+  }
+
+  /// Adds the measurement of the sensor at @a index and calls @a deliver
+  /// with the frames it releases, oldest first.
+  void Push(size_t index, DataPtr data, DeliverFunction deliver) {
+    const auto now = Clock::now();
+    const size_t frame = data->GetFrame();
+    std::vector<Frame> ready;
+    size_t ticket = 0u;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_has_released && (frame <= _last_released)) {
+        ++_stats.late;
+        return;
+      }
+      auto it = _pending.begin();
+      while ((it != _pending.end()) && (it->frame < frame)) {
+        ++it;
+      }
+      if ((it == _pending.end()) || (it->frame != frame)) {
+        it = _pending.insert(it, Pending{frame, 0u, now, std::vector<DataPtr>(_sensor_count)});
+      }
+      if (it->data[index] == nullptr) {
+        ++it->count;
+      }
+      it->data[index] = std::move(data);
+      if (it->count == _sensor_count) {
+        const auto complete = static_cast<size_t>(std::distance(_pending.begin(), it)) + 1u;
+        for (size_t i = 0u; i < complete; ++i) {
+          ReleaseFront(ready);
+        }
+      }
+      while (!_pending.empty() &&
+             ((_pending.size() > _capacity) || IsExpired(_pending.front(), now))) {
+        ReleaseFront(ready);
+      }
+      if (ready.empty()) {
+        return;
+      }
+      ticket = _next_ticket++;
+    }
+    DeliverInOrder(ticket, std::move(ready), std::move(deliver));
+  }
+
+  /// Releases every pending frame, as if they had expired, and calls
+  /// @a deliver with the ones the policy delivers.
+  void Flush(DeliverFunction deliver) {
+    std::vector<Frame> ready;
+    size_t ticket = 0u;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      while (!_pending.empty()) {
+        ReleaseFront(ready);
+      }
+      if (ready.empty()) {
+        return;
+      }
+      ticket = _next_ticket++;
+    }
+    DeliverInOrder(ticket, std::move(ready), std::move(deliver));
+  }
+
+  size_t GetSensorCount() const {
+    return _sensor_count;
+  }
+
+  SensorGroupStats GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+private:
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Pending {
+    size_t frame;
+    size_t count;
+    Clock::time_point first_arrival;
+    std::vector<DataPtr> data;
+  };
+
+  struct Delivery {
+    std::vector<Frame> frames;
+    DeliverFunction deliver;
+  };
+
+  /// Waits until the frames released before @a ticket are delivered, then
+  /// delivers @a frames, followed by the queued groups whose turn comes
+  /// next. Must be called without the lock held.
+  void DeliverInOrder(size_t ticket, std::vector<Frame> frames, DeliverFunction deliver) {
+    std::unique_lock<std::mutex> lock(_delivery_mutex);
+    Delivery current{std::move(frames), std::move(deliver)};
+    if (_delivering_thread == std::this_thread::get_id()) {
+      // Waiting here would block the turn this thread is delivering.
+      _queued.emplace(ticket, std::move(current));
+      return;
+    }
+    _delivery_turn.wait(lock, [&]() { return _now_delivering == ticket; });
+    std::exception_ptr error;
+    for (;;) {
+      _delivering_thread = std::this_thread::get_id();
+      lock.unlock();
+      try {
+        current.deliver(current.frames);
+      } catch (...) {
+        // Keep passing the turn, later tickets would wait forever otherwise.
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      lock.lock();
+      _delivering_thread = std::thread::id();
+      ++_now_delivering;
+      const auto next = _queued.find(_now_delivering);
+      if (next == _queued.end()) {
+        break;
+      }
+      current = std::move(next->second);
+      _queued.erase(next);
+    }
+    lock.unlock();
+    _delivery_turn.notify_all();
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  bool IsExpired(const Pending &pending, Clock::time_point now) const {
+    return (_timeout > 0.0) &&
+        (std::chrono::duration<double>(now - pending.first_arrival).count() > _timeout);
+  }
+
+  /// Must be called with the lock held.
+  void ReleaseFront(std::vector<Frame> &ready) {
+    auto &pending = _pending.front();
+    _has_released = true;
+    _last_released = pending.frame;
+    if (pending.count == _sensor_count) {
+      ++_stats.delivered;
+      ready.emplace_back(Frame{pending.frame, std::move(pending.data)});
+    } else if (_policy == EIncompleteFramePolicy::Deliver) {
+      ++_stats.incomplete;
+      ready.emplace_back(Frame{pending.frame, std::move(pending.data)});
+    } else {
+      ++_stats.dropped;
+    }
+    _pending.pop_front();
+  }
+
+  const size_t _sensor_count;
+
+  const size_t _capacity;
+
+  const double _timeout;
+
+  const EIncompleteFramePolicy _policy;
+
+  mutable std::mutex _mutex;
+
+  std::deque<Pending> _pending;
+
+  bool _has_released = false;
+
+  size_t _last_released = 0u;
+
+  SensorGroupStats _stats;
+
+  /// Ticket of the next group of released frames, guarded by _mutex.
+  size_t _next_ticket = 0u;
+
+  std::mutex _delivery_mutex;
+
+  std::condition_variable _delivery_turn;
+
+  /// Ticket of the group of frames being delivered.
+  size_t _now_delivering = 0u;
+
+  /// Thread running a deliver function, if any.
+  std::thread::id _delivering_thread;
+
+  /// Groups released from inside a delivery, by ticket.
+  std::map<size_t, Delivery> _queued;
+};
+
+/// Listens to several sensors and calls a Python callback once per frame
+/// with a tuple of their measurements, taking the GIL only once per frame.
+class SensorGroup : private boost::noncopyable {
+public:
+
+  using SensorPtr = carla::SharedPtr<carla::client::Sensor>;
+
+  SensorGroup(const boost::python::list &sensors, double timeout, size_t capacity, EIncompleteFramePolicy policy)
+    : _sensors(ExtractSensors(sensors)),
+      _synchronizer(boost::make_shared<FrameSynchronizer>(_sensors.size(), capacity, timeout, policy)) {}
+
+  void Listen(boost::python::object callback) {
+    namespace py = boost::python;
+    if (!PyCallable_Check(callback.ptr())) {
+      PyErr_SetString(PyExc_TypeError, "callback argument must be callable!");
+      py::throw_error_already_set();
+    }
+    // We need to delete the callback while holding the GIL.
+    using Deleter = carla::PythonUtil::AcquireGILDeleter;
+    auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+    _callback = callback_ptr;
+    carla::PythonUtil::ReleaseGIL unlock;
+    for (size_t i = 0u; i < _sensors.size(); ++i) {
+      _sensors[i]->Listen([synchronizer=_synchronizer, callback=callback_ptr, i](auto message) {
+        synchronizer->Push(i, std::move(message), [callback](const std::vector<FrameSynchronizer::Frame> &frames) {
+          Deliver(*callback, frames);
+        });
+      });
+      SensorQueueRegistry::Get().Close(_sensors[i]->GetId());
+    }
+  }
+
+  bool IsListening() const {
+    for (auto &sensor : _sensors) {
+      if (!sensor->IsListening()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Stops the sensors and releases the pending frames, which the callback
+  /// receives if the policy delivers incomplete frames. Called from the
+  /// callback, they are delivered after the callback returns.
+  void Stop() {
+    auto callback = std::move(_callback);
+    carla::PythonUtil::ReleaseGIL unlock;
+    for (auto &sensor : _sensors) {
+      sensor->Stop();
+    }
+    _synchronizer->Flush([callback](const std::vector<FrameSynchronizer::Frame> &frames) {
+      if (callback != nullptr) {
+        Deliver(*callback, frames);
+      }
+    });
+  }
+
+  const std::vector<SensorPtr> &GetSensors() const {
+    return _sensors;
+  }
+
+  SensorGroupStats GetStats() const {
+    return _synchronizer->GetStats();
+  }
+
+private:
+
+  static std::vector<SensorPtr> ExtractSensors(const boost::python::list &sensors) {
+    std::vector<SensorPtr> result{
+        boost::python::stl_input_iterator<SensorPtr>(sensors),
+        boost::python::stl_input_iterator<SensorPtr>()};
+    for (auto &sensor : result) {
+      if (sensor == nullptr) {
+        throw std::invalid_argument("sensor group cannot contain None");
+      }
+    }
+    return result;
+  }
+
+  static void Deliver(
+      const boost::python::object &callback,
+      const std::vector<FrameSynchronizer::Frame> &frames) {
+    namespace py = boost::python;
+    carla::PythonUtil::AcquireGIL lock;
+    for (auto &frame : frames) {
+      try {
+        py::list measurements;
+        for (auto &data : frame.data) {
+          measurements.append(data != nullptr ? py::object(data) : py::object());
+        }
+        py::call<void>(callback.ptr(), py::tuple(measurements));
+      } catch (const py::error_already_set &) {
+        PyErr_Print();
+      }
+    }
+  }
+
+  const std::vector<SensorPtr> _sensors;
+
+  const boost::shared_ptr<FrameSynchronizer> _synchronizer;
+
+  /// Callback of the last call to Listen, to deliver the frames pending
+  /// when the group stops.
+  carla::SharedPtr<boost::python::object> _callback;
+};
+
+std::ostream &operator<<(std::ostream &out, const SensorGroupStats &stats) {
+  out << "SensorGroupStats(delivered=" << std::to_string(stats.delivered)
+      << ", incomplete=" << std::to_string(stats.incomplete)
+      << ", dropped=" << std::to_string(stats.dropped)
+      << ", late=" << std::to_string(stats.late) << ')';
+  return out;
+}
+
+void export_sensor_group() {
+  using namespace boost::python;
+
+  enum_<EIncompleteFramePolicy>("IncompleteFramePolicy")
+    .value("Drop", EIncompleteFramePolicy::Drop)
+    .value("Deliver", EIncompleteFramePolicy::Deliver)
+  ;
+
+  class_<SensorGroupStats>("SensorGroupStats", no_init)
+    .def_readonly("delivered", &SensorGroupStats::delivered)
+    .def_readonly("incomplete", &SensorGroupStats::incomplete)
+    .def_readonly("dropped", &SensorGroupStats::dropped)
+    .def_readonly("late", &SensorGroupStats::late)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<SensorGroup, boost::noncopyable, boost::shared_ptr<SensorGroup>>("SensorGroup",
+      init<list, double, size_t, EIncompleteFramePolicy>(
+      (arg("sensors"), arg("timeout")=1.0, arg("capacity")=8u, arg("policy")=EIncompleteFramePolicy::Drop)))
+    .add_property("sensors", CALL_RETURNING_LIST(SensorGroup, GetSensors))
+    .add_property("is_listening", &SensorGroup::IsListening)
+    .def("listen", &SensorGroup::Listen, (arg("callback")))
+    .def("stop", &SensorGroup::Stop)
+    .def("get_stats", &SensorGroup::GetStats)
+  ;
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/PythonUtil.h>
+#include <carla/rpc/ActorId.h>
+#include <carla/sensor/SensorData.h>
+
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <stdexcept>
+#include <vector>
+
+/// What to do when a measurement arrives to a full SensorQueue.
+enum class ESensorQueuePolicy {
+  DropOldest,
+  DropNewest
+};
+
+/// Bounded queue of measurements filled by the streaming threads without
+/// taking the GIL. Python threads pull from it with the GIL released while
+/// they wait. The queue is closed when its sensor stops feeding it, which
+/// wakes up the waiting threads.
+class SensorQueue : private boost::noncopyable {
+public:
+
+  using DataPtr = carla::SharedPtr<carla::sensor::SensorData>;
+
+  SensorQueue(size_t max_size, ESensorQueuePolicy policy)
+    : _max_size(max_size),
+      _policy(policy) {
+    if (max_size == 0u) {
+      throw std::invalid_argument("sensor queue needs a maxsize of at least one");
+    }
+  }
+
+  void Push(DataPtr data) {
+    DataPtr dropped;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_queue.size() >= _max_size) {
+        ++_dropped;
+        if (_policy == ESensorQueuePolicy::DropNewest) {
+          return;
+        }
+        // Destroy the measurement outside the lock.
+        dropped = std::move(_queue.front());
+        _queue.pop_front();
+      }
+      _queue.push_back(std::move(data));
+    }
+    _condition.notify_all();
+  }
+
+  /// Waits until @a count measurements are available, with no limit if
+  /// @a seconds is empty, and removes up to @a count of them. A full queue
+  /// counts as available; a closed queue stops waiting.
+  std::vector<DataPtr> Pop(size_t count, boost::optional<double> seconds) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    const size_t wanted = std::min(count, _max_size);
+    auto available = [&]() { return _closed || (_queue.size() >= wanted); };
+    if (!seconds.has_value()) {
+      _condition.wait(lock, available);
+    } else if (*seconds > 0.0) {
+      _condition.wait_for(lock, std::chrono::duration<double>(*seconds), available);
+    }
+    const auto end = _queue.begin() + static_cast<std::ptrdiff_t>(std::min(count, _queue.size()));
+    std::vector<DataPtr> result{std::make_move_iterator(_queue.begin()), std::make_move_iterator(end)};
+    _queue.erase(_queue.begin(), end);
+    return result;
+  }
+
+  /// Stops waiting for new measurements, the ones already queued can still
+  /// be retrieved.
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+    }
+    _condition.notify_all();
+  }
+
+  size_t GetSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+  }
+
+  size_t GetMaxSize() const {
+    return _max_size;
+  }
+
+  size_t GetDropped() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+  }
+
+private:
+
+  const size_t _max_size;
+
+  const ESensorQueuePolicy _policy;
+
+  mutable std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  std::deque<DataPtr> _queue;
+
+  size_t _dropped = 0u;
+
+  bool _closed = false;
+};
+
+/// Queue fed by each sensor, so it can be closed when the sensor stops
+/// feeding it.
+class SensorQueueRegistry : private boost::noncopyable {
+public:
+
+  static SensorQueueRegistry &Get() {
+    static SensorQueueRegistry registry;
+    return registry;
+  }
+
+  /// Registers the queue now fed by the sensor @a id, closing the previous
+  /// one.
+  void Register(carla::ActorId id, const boost::shared_ptr<SensorQueue> &queue) {
+    boost::weak_ptr<SensorQueue> previous = queue;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::swap(_queues[id], previous);
+    }
+    CloseQueue(previous);
+  }
+
+  /// Closes the queue fed by the sensor @a id, if any.
+  void Close(carla::ActorId id) {
+    boost::weak_ptr<SensorQueue> queue;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _queues.find(id);
+      if (it == _queues.end()) {
+        return;
+      }
+      queue = std::move(it->second);
+      _queues.erase(it);
+    }
+    CloseQueue(queue);
+  }
+
+private:
+
+  static void CloseQueue(const boost::weak_ptr<SensorQueue> &weak) {
+    auto queue = weak.lock();
+    if (queue != nullptr) {
+      queue->Close();
+    }
+  }
+
+  std::mutex _mutex;
+
+  std::unordered_map<carla::ActorId, boost::weak_ptr<SensorQueue>> _queues;
+};
+
+/// Converts a Python timeout, None to wait without limit, as queue.Queue
+/// does.
+static boost::optional<double> ExtractQueueTimeout(const boost::python::object &timeout) {
+  namespace py = boost::python;
+  if (timeout.is_none()) {
+    return boost::none;
+  }
+  const double seconds = py::extract<double>(timeout);
+  if (seconds < 0.0) {
+    PyErr_SetString(PyExc_ValueError, "'timeout' must be a non-negative number");
+    py::throw_error_already_set();
+  }
+  return seconds;
+}
+
+static std::vector<SensorQueue::DataPtr> PopFromSensorQueue(
+    SensorQueue &self,
+    size_t count,
+    const boost::python::object &timeout) {
+  const auto seconds = ExtractQueueTimeout(timeout);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.Pop(count, seconds);
+}
+
+/// Raises queue.Empty, so the queue is a drop-in replacement for the
+/// Python queues used to receive sensor data.
+static void ThrowQueueEmpty() {
+  namespace py = boost::python;
+  py::object empty = py::import("queue").attr("Empty");
+  PyErr_SetNone(empty.ptr());
+  py::throw_error_already_set();
+}
+
+void export_sensor_queue() {
+  using namespace boost::python;
+
+  enum_<ESensorQueuePolicy>("SensorQueuePolicy")
+    .value("DropOldest", ESensorQueuePolicy::DropOldest)
+    .value("DropNewest", ESensorQueuePolicy::DropNewest)
+  ;
+
+  class_<SensorQueue, boost::noncopyable, boost::shared_ptr<SensorQueue>>("SensorQueue", no_init)
+    .add_property("maxsize", &SensorQueue::GetMaxSize)
+    .add_property("dropped", &SensorQueue::GetDropped)
+    .def("get", +[](SensorQueue &self, const object &timeout) {
+      auto items = PopFromSensorQueue(self, 1u, timeout);
+      if (items.empty()) {
+        ThrowQueueEmpty();
+      }
+      return object(items.front());
+    }, (arg("timeout")=object()))
+    .def("get_batch", +[](SensorQueue &self, size_t count, const object &timeout) {
+      list result;
+      for (auto &item : PopFromSensorQueue(self, count, timeout)) {
+        result.append(item);
+      }
+      return result;
+    }, (arg("n"), arg("timeout")=object()))
+    .def("qsize", &SensorQueue::GetSize)
+    .def("empty", +[](const SensorQueue &self) { return self.GetSize() == 0u; })
+    .def("__len__", &SensorQueue::GetSize)
+  ;
+}
@@ -11,6 +11,17 @@
 
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace client {
 
@@ -27,6 +38,367 @@ namespace client {
 } // namespace client
 } // namespace carla
 
+/// Actors that appeared, disappeared, or changed between two snapshots.
+/// The ids are sorted.
+struct SnapshotDiff {
+  std::vector<carla::ActorId> added;
+  std::vector<carla::ActorId> removed;
+  std::vector<carla::ActorId> changed;
+
+  bool HasChanges() const {
+    return !(added.empty() && removed.empty() && changed.empty());
+  }
+};
+
+std::ostream &operator<<(std::ostream &out, const SnapshotDiff &diff) {
+  out << "SnapshotDiff(added=" << std::to_string(diff.added.size())
+      << ", removed=" << std::to_string(diff.removed.size())
+      << ", changed=" << std::to_string(diff.changed.size()) << ')';
+  return out;
+}
+
+/// Writes the x, y, and z of @a vector to @a dst.
+template <typename T>
+static void WriteXYZ(const T &vector, float *dst) {
+  dst[0u] = vector.x;
+  dst[1u] = vector.y;
+  dst[2u] = vector.z;
+}
+
+/// A column exported by SnapshotToArrays, three floats per actor.
+struct SnapshotField {
+  const char *name;
+  void (*write)(const carla::client::ActorSnapshot &actor, float *dst);
+};
+
+static const std::array<SnapshotField, 5u> &GetSnapshotFields() {
+  using carla::client::ActorSnapshot;
+  static const std::array<SnapshotField, 5u> fields{{
+    {"location", [](const ActorSnapshot &actor, float *dst) { WriteXYZ(actor.transform.location, dst); }},
+    {"rotation", [](const ActorSnapshot &actor, float *dst) {
+      dst[0u] = actor.transform.rotation.pitch;
+      dst[1u] = actor.transform.rotation.yaw;
+      dst[2u] = actor.transform.rotation.roll;
+    }},
+    {"velocity", [](const ActorSnapshot &actor, float *dst) { WriteXYZ(actor.velocity, dst); }},
+    {"angular_velocity", [](const ActorSnapshot &actor, float *dst) { WriteXYZ(actor.angular_velocity, dst); }},
+    {"acceleration", [](const ActorSnapshot &actor, float *dst) { WriteXYZ(actor.acceleration, dst); }}
+  }};
+  return fields;
+}
+
+/// Fields named in the Python sequence @a fields, or all of them if None.
+static std::vector<const SnapshotField *> ExtractSnapshotFields(const boost::python::object &fields) {
+  const auto &all = GetSnapshotFields();
+  std::vector<const SnapshotField *> result;
+  if (fields.is_none()) {
+    for (auto &field : all) {
+      result.emplace_back(&field);
+    }
+    return result;
+  }
+  std::for_each(
+      boost::python::stl_input_iterator<std::string>(fields),
+      boost::python::stl_input_iterator<std::string>(),
+      [&](const std::string &name) {
+        auto it = std::find_if(all.begin(), all.end(), [&](const SnapshotField &field) {
+          return name == field.name;
+        });
+        if (it == all.end()) {
+          throw std::invalid_argument("unknown actor state field '" + name + "'");
+        }
+        result.emplace_back(&*it);
+      });
+  return result;
+}
+
+/// Exports the state of the actors in @a self as one array per field, with
+/// a row per actor. If @a ids is not None only those actors are exported,
+/// in the same order, skipping the ones not in the snapshot. The "id"
+/// column is always exported, @a fields selects the others.
+static boost::python::dict SnapshotToArrays(
+    const carla::client::WorldSnapshot &self,
+    const boost::python::object &ids,
+    const boost::python::object &fields) {
+  namespace py = boost::python;
+  const auto selected = ExtractSnapshotFields(fields);
+  std::vector<carla::client::ActorSnapshot> actors;
+  if (ids.is_none()) {
+    actors.assign(self.begin(), self.end());
+  } else {
+    const std::vector<carla::ActorId> actor_ids{
+        py::stl_input_iterator<carla::ActorId>(ids),
+        py::stl_input_iterator<carla::ActorId>()};
+    carla::PythonUtil::ReleaseGIL unlock;
+    actors.reserve(actor_ids.size());
+    for (auto id : actor_ids) {
+      auto actor = self.Find(id);
+      if (actor.has_value()) {
+        actors.emplace_back(*actor);
+      }
+    }
+  }
+  const auto rows = static_cast<Py_ssize_t>(actors.size());
+  py::dict result;
+  carla::ActorId *id = nullptr;
+  result["id"] = MakeNumPyArray("I", {rows}, id);
+  std::vector<float *> columns(selected.size(), nullptr);
+  for (size_t j = 0u; j < selected.size(); ++j) {
+    result[selected[j]->name] = MakeNumPyArray("f", {rows, 3}, columns[j]);
+  }
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    for (size_t i = 0u; i < actors.size(); ++i) {
+      id[i] = actors[i].id;
+      for (size_t j = 0u; j < selected.size(); ++j) {
+        selected[j]->write(actors[i], columns[j] + 3u * i);
+      }
+    }
+  }
+  return result;
+}
+
+/// Thresholds above which an actor is considered to have changed.
+struct SnapshotEpsilons {
+  float location;
+  float rotation;
+  float velocity;
+};
+
+static bool IsDifferent(const carla::geom::Vector3D &a, const carla::geom::Vector3D &b, float epsilon) {
+  const float dx = a.x - b.x;
+  const float dy = a.y - b.y;
+  const float dz = a.z - b.z;
+  return dx * dx + dy * dy + dz * dz > epsilon * epsilon;
+}
+
+/// Compares angles in degrees the shortest way around.
+static bool IsDifferent(float a, float b, float epsilon) {
+  return std::abs(std::remainder(a - b, 360.0f)) > epsilon;
+}
+
+static bool IsDifferent(
+    const carla::client::ActorSnapshot &a,
+    const carla::client::ActorSnapshot &b,
+    const SnapshotEpsilons &epsilons) {
+  return
+      IsDifferent(a.transform.location, b.transform.location, epsilons.location) ||
+      IsDifferent(a.transform.rotation.pitch, b.transform.rotation.pitch, epsilons.rotation) ||
+      IsDifferent(a.transform.rotation.yaw, b.transform.rotation.yaw, epsilons.rotation) ||
+      IsDifferent(a.transform.rotation.roll, b.transform.rotation.roll, epsilons.rotation) ||
+      IsDifferent(a.velocity, b.velocity, epsilons.velocity) ||
+      IsDifferent(a.angular_velocity, b.angular_velocity, epsilons.rotation);
+}
+
+/// Actors of @a snapshot sorted by id.
+static std::vector<std::pair<carla::ActorId, const carla::client::ActorSnapshot *>> SortById(
+    const carla::client::WorldSnapshot &snapshot) {
+  std::vector<std::pair<carla::ActorId, const carla::client::ActorSnapshot *>> result;
+  result.reserve(snapshot.size());
+  for (auto &actor : snapshot) {
+    result.emplace_back(actor.id, &actor);
+  }
+  std::sort(result.begin(), result.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.first < rhs.first;
+  });
+  return result;
+}
+
+/// Compares @a self to @a previous by merging both lists of actors sorted
+/// by id.
+static SnapshotDiff DiffSnapshots(
+    const carla::client::WorldSnapshot &self,
+    const carla::client::WorldSnapshot &previous,
+    float location_epsilon,
+    float rotation_epsilon,
+    float velocity_epsilon) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  const SnapshotEpsilons epsilons{location_epsilon, rotation_epsilon, velocity_epsilon};
+  const auto current = SortById(self);
+  const auto before = SortById(previous);
+  SnapshotDiff result;
+  auto it = current.begin();
+  auto jt = before.begin();
+  while ((it != current.end()) || (jt != before.end())) {
+    if ((jt == before.end()) || ((it != current.end()) && (it->first < jt->first))) {
+      result.added.emplace_back((it++)->first);
+    } else if ((it == current.end()) || (jt->first < it->first)) {
+      result.removed.emplace_back((jt++)->first);
+    } else {
+      if (IsDifferent(*it->second, *jt->second, epsilons)) {
+        result.changed.emplace_back(it->first);
+      }
+      ++it;
+      ++jt;
+    }
+  }
+  return result;
+}
+
+static boost::python::object IdsToArray(const std::vector<carla::ActorId> &ids) {
+  carla::ActorId *data = nullptr;
+  auto result = MakeNumPyArray("I", {static_cast<Py_ssize_t>(ids.size())}, data);
+  std::copy(ids.begin(), ids.end(), data);
+  return result;
+}
+
+/// Spatial index of the actors of the snapshots queried most recently, built
+/// the first time each snapshot is queried.
+class SnapshotIndexCache : private boost::noncopyable {
+public:
+
+  static std::shared_ptr<const geom_kernels::KdTree> Get(const carla::client::WorldSnapshot &snapshot) {
+    static SnapshotIndexCache cache;
+    return cache.Find(snapshot);
+  }
+
+private:
+
+  /// A snapshot id is only unique within an episode, so the frame is part of
+  /// the key too.
+  using Key = std::pair<size_t, uint64_t>;
+
+  static constexpr size_t kCapacity = 4u;
+
+  std::shared_ptr<const geom_kernels::KdTree> Find(const carla::client::WorldSnapshot &snapshot) {
+    const Key key{snapshot.GetId(), snapshot.GetTimestamp().frame};
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &entry : _entries) {
+      if (entry.first == key) {
+        return entry.second;
+      }
+    }
+    std::vector<geom_kernels::KdTree::Item> items;
+    items.reserve(snapshot.size());
+    for (auto &actor : snapshot) {
+      items.push_back({actor.transform.location, actor.id});
+    }
+    auto index = std::make_shared<const geom_kernels::KdTree>(std::move(items));
+    _entries.emplace_front(key, index);
+    if (_entries.size() > kCapacity) {
+      _entries.pop_back();
+    }
+    return index;
+  }
+
+  std::mutex _mutex;
+
+  std::deque<std::pair<Key, std::shared_ptr<const geom_kernels::KdTree>>> _entries;
+};
+
+/// Predicate accepting every actor, or only the ones in @a ids if not None.
+class ActorIdFilter {
+public:
+
+  explicit ActorIdFilter(const boost::python::object &ids)
+    : _all(ids.is_none()) {
+    if (!_all) {
+      _ids.insert(
+          boost::python::stl_input_iterator<carla::ActorId>(ids),
+          boost::python::stl_input_iterator<carla::ActorId>());
+    }
+  }
+
+  bool operator()(carla::ActorId id) const {
+    return _all || (_ids.find(id) != _ids.end());
+  }
+
+private:
+
+  bool _all;
+
+  std::unordered_set<carla::ActorId> _ids;
+};
+
+static boost::python::object NeighborsToArray(const std::vector<geom_kernels::KdTree::Neighbor> &neighbors) {
+  carla::ActorId *data = nullptr;
+  auto result = MakeNumPyArray("I", {static_cast<Py_ssize_t>(neighbors.size())}, data);
+  for (auto &neighbor : neighbors) {
+    *data++ = neighbor.second;
+  }
+  return result;
+}
+
+static boost::python::object QueryRadius(
+    const carla::client::WorldSnapshot &self,
+    const carla::geom::Location &location,
+    float radius,
+    const boost::python::object &ids) {
+  const ActorIdFilter filter(ids);
+  std::vector<geom_kernels::KdTree::Neighbor> neighbors;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    neighbors = SnapshotIndexCache::Get(self)->QueryRadius(location, radius, filter);
+  }
+  return NeighborsToArray(neighbors);
+}
+
+static boost::python::object QueryKnn(
+    const carla::client::WorldSnapshot &self,
+    const carla::geom::Location &location,
+    size_t k,
+    const boost::python::object &ids) {
+  const ActorIdFilter filter(ids);
+  std::vector<geom_kernels::KdTree::Neighbor> neighbors;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    neighbors = SnapshotIndexCache::Get(self)->QueryKnn(location, k, filter);
+  }
+  return NeighborsToArray(neighbors);
+}
+
+static boost::python::list QueryRadiusBatch(
+    const carla::client::WorldSnapshot &self,
+    const boost::python::object &locations,
+    float radius,
+    const boost::python::object &ids) {
+  const auto queries = ExtractLocations(locations);
+  const ActorIdFilter filter(ids);
+  std::vector<std::vector<geom_kernels::KdTree::Neighbor>> neighbors(queries.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto index = SnapshotIndexCache::Get(self);
+    WorkerPool::Get().ParallelFor(queries.size(), 16u, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        neighbors[i] = index->QueryRadius(queries[i], radius, filter);
+      }
+    });
+  }
+  boost::python::list result;
+  for (auto &item : neighbors) {
+    result.append(NeighborsToArray(item));
+  }
+  return result;
+}
+
+/// Returns an N x k array of ids, rows with less than k neighbors are padded
+/// with zeros.
+static boost::python::object QueryKnnBatch(
+    const carla::client::WorldSnapshot &self,
+    const boost::python::object &locations,
+    size_t k,
+    const boost::python::object &ids) {
+  const auto queries = ExtractLocations(locations);
+  const ActorIdFilter filter(ids);
+  carla::ActorId *data = nullptr;
+  auto result = MakeNumPyArray("I", {static_cast<Py_ssize_t>(queries.size()), static_cast<Py_ssize_t>(k)}, data);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto index = SnapshotIndexCache::Get(self);
+    WorkerPool::Get().ParallelFor(queries.size(), 16u, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const auto neighbors = index->QueryKnn(queries[i], k, filter);
+        auto *row = data + i * k;
+        std::fill(row, row + k, carla::ActorId(0u));
+        for (size_t j = 0u; j < neighbors.size(); ++j) {
+          row[j] = neighbors[j].second;
+        }
+      }
+    });
+  }
+  return result;
+}
+
 void export_snapshot() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -40,6 +412,15 @@ void export_snapshot() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<SnapshotDiff>("SnapshotDiff", no_init)
+    .add_property("added", +[](const SnapshotDiff &self) { return IdsToArray(self.added); })
+    .add_property("removed", +[](const SnapshotDiff &self) { return IdsToArray(self.removed); })
+    .add_property("changed", +[](const SnapshotDiff &self) { return IdsToArray(self.changed); })
+    .def("__nonzero__", &SnapshotDiff::HasChanges)
+    .def("__bool__", &SnapshotDiff::HasChanges)
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<cc::WorldSnapshot>("WorldSnapshot", no_init)
     .add_property("id", &cc::WorldSnapshot::GetId)
     .add_property("frame", +[](const cc::WorldSnapshot &self) { return self.GetTimestamp().frame; })
@@ -52,6 +433,16 @@ void export_snapshot() {
     /// @}
     .def("has_actor", &cc::WorldSnapshot::Contains, (arg("actor_id")))
     .def("find", CALL_RETURNING_OPTIONAL_1(cc::WorldSnapshot, Find, carla::ActorId), (arg("actor_id")))
+    .def("to_arrays", &SnapshotToArrays, (arg("ids")=object(), arg("fields")=object()))
+    .def("query_radius", &QueryRadius, (arg("location"), arg("radius"), arg("ids")=object()))
+    .def("query_knn", &QueryKnn, (arg("location"), arg("k"), arg("ids")=object()))
+    .def("query_radius_batch", &QueryRadiusBatch, (arg("locations"), arg("radius"), arg("ids")=object()))
+    .def("query_knn_batch", &QueryKnnBatch, (arg("locations"), arg("k"), arg("ids")=object()))
+    .def("diff", &DiffSnapshots, (
+        arg("previous"),
+        arg("location_epsilon")=0.001f,
+        arg("rotation_epsilon")=0.01f,
+        arg("velocity_epsilon")=0.001f))
     .def("__len__", &cc::WorldSnapshot::size)
     .def("__iter__", range(&cc::WorldSnapshot::begin, &cc::WorldSnapshot::end))
     .def("__eq__", &cc::WorldSnapshot::operator==)
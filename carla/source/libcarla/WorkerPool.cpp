@@ -0,0 +1,205 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Process-wide pool of worker threads shared by the bulk helpers of the
+/// module. Threads are started lazily on first use.
+///
+/// Work is submitted with ParallelFor, which splits a range in chunks that
+/// idle workers claim one at a time. The calling thread claims chunks too,
+/// so a call always completes even if every worker is busy, and nested
+/// calls do not deadlock.
+class WorkerPool : private boost::noncopyable {
+public:
+
+  /// The pool is intentionally leaked, joining threads from static
+  /// destructors while the interpreter shuts down is not safe everywhere.
+  static WorkerPool &Get() {
+    static auto *pool = new WorkerPool;
+    return *pool;
+  }
+
+  /// Number of worker threads, not counting the calling thread.
+  size_t GetSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+  }
+
+  /// Changes the number of worker threads. With zero workers every call
+  /// runs on the calling thread.
+  void SetSize(size_t size) {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _size = size;
+      ++_generation;
+      threads.swap(_threads);
+    }
+    // Pending jobs are finished by their callers.
+    _condition.notify_all();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  /// Calls @a body(begin, end) for consecutive sub-ranges of [0, count) of
+  /// at most @a grain elements, in parallel. Exceptions thrown by @a body
+  /// are propagated to the caller once all the chunks are done.
+  template <typename FunctorT>
+  void ParallelFor(size_t count, size_t grain, FunctorT &&body) {
+    grain = std::max<size_t>(grain, 1u);
+    if (count <= grain || !Start()) {
+      if (count > 0u) {
+        body(size_t(0u), count);
+      }
+      return;
+    }
+    auto job = std::make_shared<Job>(count, grain, std::ref(body));
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _jobs.push_back(job);
+    }
+    _condition.notify_all();
+    job->RunChunks();
+    job->Wait();
+    if (job->error) {
+      std::rethrow_exception(job->error);
+    }
+  }
+
+private:
+
+  struct Job {
+    Job(size_t count, size_t grain, std::function<void(size_t, size_t)> body)
+      : body(std::move(body)),
+        count(count),
+        grain(grain),
+        chunks((count + grain - 1u) / grain) {}
+
+    /// Runs chunks until none is left to claim.
+    void RunChunks() {
+      size_t finished = 0u;
+      for (size_t chunk = next.fetch_add(1u); chunk < chunks; chunk = next.fetch_add(1u)) {
+        const size_t begin = chunk * grain;
+        try {
+          body(begin, std::min(begin + grain, count));
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+        ++finished;
+      }
+      if ((finished > 0u) && (done.fetch_add(finished) + finished == chunks)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_all();
+      }
+    }
+
+    bool HasChunks() const {
+      return next.load() < chunks;
+    }
+
+    void Wait() {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this]() { return done.load() == chunks; });
+    }
+
+    const std::function<void(size_t, size_t)> body;
+
+    const size_t count;
+
+    const size_t grain;
+
+    const size_t chunks;
+
+    std::atomic<size_t> next{0u};
+
+    std::atomic<size_t> done{0u};
+
+    std::mutex mutex;
+
+    std::condition_variable condition;
+
+    std::exception_ptr error;
+  };
+
+  WorkerPool()
+    : _size(std::max(std::thread::hardware_concurrency(), 2u) - 1u) {}
+
+  /// Starts the workers if needed, returns false if the pool has none.
+  bool Start() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_threads.empty() && (_size > 0u)) {
+      _threads.reserve(_size);
+      for (size_t i = 0u; i < _size; ++i) {
+        _threads.emplace_back([this, generation = _generation]() { Run(generation); });
+      }
+    }
+    return !_threads.empty();
+  }
+
+  /// Worker loop, returns when the pool is resized.
+  void Run(size_t generation) {
+    for (;;) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [&]() { return (_generation != generation) || !_jobs.empty(); });
+        if (_generation != generation) {
+          return;
+        }
+        job = _jobs.front();
+        if (!job->HasChunks()) {
+          _jobs.pop_front();
+          continue;
+        }
+      }
+      job->RunChunks();
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_jobs.empty() && (_jobs.front() == job)) {
+        _jobs.pop_front();
+      }
+    }
+  }
+
+  mutable std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  std::deque<std::shared_ptr<Job>> _jobs;
+
+  std::vector<std::thread> _threads;
+
+  size_t _size;
+
+  /// Incremented on each resize to retire the current workers.
+  size_t _generation = 0u;
+};
+
+static void SetWorkerThreads(size_t count) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  WorkerPool::Get().SetSize(count);
+}
+
+void export_worker_pool() {
+  using namespace boost::python;
+
+  def("set_worker_threads", &SetWorkerThreads, (arg("count")));
+  def("get_worker_threads", +[]() { return WorkerPool::Get().GetSize(); });
+}
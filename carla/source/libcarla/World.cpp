@@ -7,12 +7,19 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Actor.h>
 #include <carla/client/ActorList.h>
+#include <carla/client/Vehicle.h>
 #include <carla/client/World.h>
 #include <carla/rpc/EnvironmentObject.h>
 #include <carla/rpc/ObjectLabel.h>
 
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace client {
 
@@ -66,6 +73,8 @@ static size_t OnTick(carla::client::World &self, boost::python::object callback)
 
 static auto Tick(carla::client::World &world, double seconds) {
   carla::PythonUtil::ReleaseGIL unlock;
+  // Batches sent with apply_batch_async before this call belong to this step.
+  CommandQueue::Get().Flush();
   return world.Tick(TimeDurationFromSeconds(seconds));
 }
 
@@ -82,6 +91,73 @@ static auto GetActorsById(carla::client::World &self, const boost::python::list
   return self.GetActors(ids);
 }
 
+static auto GetActorStates(
+    const carla::client::World &self,
+    const boost::python::object &actor_ids,
+    const boost::python::object &fields) {
+  return SnapshotToArrays(self.GetSnapshot(), actor_ids, fields);
+}
+
+/// Exports the last control applied to each vehicle in @a actor_ids as one
+/// array per field, in the order of @a actor_ids. Actors that are not
+/// vehicles are skipped. The controls are read from the episode state
+/// received with the last tick, not requested from the simulator.
+static boost::python::dict GetVehicleControls(carla::client::World &self, const boost::python::object &actor_ids) {
+  namespace py = boost::python;
+  const std::vector<carla::ActorId> ids{
+      py::stl_input_iterator<carla::ActorId>(actor_ids),
+      py::stl_input_iterator<carla::ActorId>()};
+  std::vector<std::pair<carla::ActorId, carla::rpc::VehicleControl>> controls;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    std::unordered_map<carla::ActorId, carla::rpc::VehicleControl> found;
+    const auto actors = self.GetActors(ids);
+    for (auto actor : *actors) {
+      auto vehicle = boost::dynamic_pointer_cast<carla::client::Vehicle>(actor);
+      if (vehicle != nullptr) {
+        found.emplace(vehicle->GetId(), vehicle->GetControl());
+      }
+    }
+    controls.reserve(found.size());
+    for (auto id : ids) {
+      auto it = found.find(id);
+      if (it != found.end()) {
+        controls.emplace_back(*it);
+      }
+    }
+  }
+  const auto rows = static_cast<Py_ssize_t>(controls.size());
+  carla::ActorId *id = nullptr;
+  float *throttle = nullptr;
+  float *steer = nullptr;
+  float *brake = nullptr;
+  bool *hand_brake = nullptr;
+  bool *reverse = nullptr;
+  bool *manual_gear_shift = nullptr;
+  int32_t *gear = nullptr;
+  py::dict result;
+  result["id"] = MakeNumPyArray("I", {rows}, id);
+  result["throttle"] = MakeNumPyArray("f", {rows}, throttle);
+  result["steer"] = MakeNumPyArray("f", {rows}, steer);
+  result["brake"] = MakeNumPyArray("f", {rows}, brake);
+  result["hand_brake"] = MakeNumPyArray("?", {rows}, hand_brake);
+  result["reverse"] = MakeNumPyArray("?", {rows}, reverse);
+  result["manual_gear_shift"] = MakeNumPyArray("?", {rows}, manual_gear_shift);
+  result["gear"] = MakeNumPyArray("i", {rows}, gear);
+  for (size_t i = 0u; i < controls.size(); ++i) {
+    const auto &control = controls[i].second;
+    id[i] = controls[i].first;
+    throttle[i] = control.throttle;
+    steer[i] = control.steer;
+    brake[i] = control.brake;
+    hand_brake[i] = control.hand_brake;
+    reverse[i] = control.reverse;
+    manual_gear_shift[i] = control.manual_gear_shift;
+    gear[i] = control.gear;
+  }
+  return result;
+}
+
 static auto GetVehiclesLightStates(carla::client::World &self) {
   boost::python::dict dict;
   auto list = self.GetVehiclesLightStates();
@@ -91,12 +167,8 @@ static auto GetVehiclesLightStates(carla::client::World &self) {
   return dict;
 }
 
-static auto GetLevelBBs(const carla::client::World &self, uint8_t queried_tag) {
-  boost::python::list result;
-  for (const auto &bb : self.GetLevelBBs(queried_tag)) {
-    result.append(bb);
-  }
-  return result;
+static auto GetLevelBBs(const carla::client::World &self, uint8_t queried_tag, bool as_array) {
+  return ToListOrArray(self.GetLevelBBs(queried_tag), as_array);
 }
 
 static auto GetEnvironmentObjects(const carla::client::World &self, uint8_t queried_tag) {
@@ -120,6 +192,28 @@ static void EnableEnvironmentObjects(
   self.EnableEnvironmentObjects(env_objects_ids, enable);
 }
 
+template <>
+struct ArrayRowTraits<carla::rpc::LabelledPoint> {
+  struct Row {
+    float x, y, z;
+    uint8_t label;
+  };
+
+  static std::string GetFormat() {
+    return StructFormat()
+        .Field(offsetof(Row, x), "f", sizeof(float), "x")
+        .Field(offsetof(Row, y), "f", sizeof(float), "y")
+        .Field(offsetof(Row, z), "f", sizeof(float), "z")
+        .Field(offsetof(Row, label), "B", sizeof(uint8_t), "label")
+        .Build(sizeof(Row));
+  }
+
+  static Row MakeRow(const carla::rpc::LabelledPoint &point) {
+    const auto &l = point._location;
+    return {l.x, l.y, l.z, static_cast<uint8_t>(point._label)};
+  }
+};
+
 void export_world() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -321,6 +415,8 @@ void export_world() {
     .def("get_actor", CONST_CALL_WITHOUT_GIL_1(cc::World, GetActor, carla::ActorId), (arg("actor_id")))
     .def("get_actors", CONST_CALL_WITHOUT_GIL(cc::World, GetActors))
     .def("get_actors", &GetActorsById, (arg("actor_ids")))
+    .def("get_actor_states", &GetActorStates, (arg("actor_ids")=object(), arg("fields")=object()))
+    .def("get_vehicle_controls", &GetVehicleControls, (arg("actor_ids")))
     .def("spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(SpawnActor))
     .def("try_spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(TrySpawnActor))
     .def("wait_for_tick", &WaitForTick, (arg("seconds")=0.0))
@@ -337,10 +433,10 @@ void export_world() {
     .def("reset_all_traffic_lights", &cc::World::ResetAllTrafficLights)
     .def("get_lightmanager", CONST_CALL_WITHOUT_GIL(cc::World, GetLightManager))
     .def("freeze_all_traffic_lights", &cc::World::FreezeAllTrafficLights, (arg("frozen")))
-    .def("get_level_bbs", &GetLevelBBs, (arg("bb_type")=cr::CityObjectLabel::Any))
+    .def("get_level_bbs", &GetLevelBBs, (arg("bb_type")=cr::CityObjectLabel::Any, arg("as_array")=false))
     .def("get_environment_objects", &GetEnvironmentObjects, (arg("object_type")=cr::CityObjectLabel::Any))
     .def("enable_environment_objects", &EnableEnvironmentObjects, (arg("env_objects_ids"), arg("enable")))
-    .def("cast_ray", CALL_RETURNING_LIST_2(cc::World, CastRay, cg::Location, cg::Location), (arg("initial_location"), arg("final_location")))
+    .def("cast_ray", CALL_RETURNING_ARRAY_2(cc::World, CastRay, cg::Location, cg::Location), (arg("initial_location"), arg("final_location"), arg("as_array")=false))
     .def("project_point", CALL_RETURNING_OPTIONAL_3(cc::World, ProjectPoint, cg::Location, cg::Vector3D, float), (arg("location"), arg("direction"), arg("search_distance")=10000.f))
     .def("ground_projection", CALL_RETURNING_OPTIONAL_2(cc::World, GroundProjection, cg::Location, float), (arg("location"), arg("search_distance")=10000.f))
     .def("get_names_of_all_objects", CALL_RETURNING_LIST(cc::World, GetNamesOfAllObjects))
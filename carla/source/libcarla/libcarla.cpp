@@ -118,6 +118,25 @@ std::vector<T> PythonLitstToVector(boost::python::list &input) {
       return result; \
     }
 
+// Convenient for const requests returning a list of plain data. Takes an
+// extra as_array argument to return a NumPy structured array instead of a
+// Python list, see ToListOrArray.
+#define CALL_RETURNING_ARRAY(cls, fn) +[](const cls &self, bool as_array) { \
+      return ToListOrArray(self.fn(), as_array); \
+    }
+
+#define CALL_RETURNING_ARRAY_1(cls, fn, T1_) +[](const cls &self, T1_ t1, bool as_array) { \
+      return ToListOrArray(self.fn(std::forward<T1_>(t1)), as_array); \
+    }
+
+#define CALL_RETURNING_ARRAY_2(cls, fn, T1_, T2_) +[](const cls &self, T1_ t1, T2_ t2, bool as_array) { \
+      return ToListOrArray(self.fn(std::forward<T1_>(t1), std::forward<T2_>(t2)), as_array); \
+    }
+
+#define CALL_RETURNING_ARRAY_3(cls, fn, T1_, T2_, T3_) +[](const cls &self, T1_ t1, T2_ t2, T3_ t3, bool as_array) { \
+      return ToListOrArray(self.fn(std::forward<T1_>(t1), std::forward<T2_>(t2), std::forward<T3_>(t3)), as_array); \
+    }
+
 #define CALL_RETURNING_OPTIONAL(cls, fn) +[](const cls &self) { \
       auto optional = self.fn(); \
       return OptionalToPythonObject(optional); \
@@ -216,15 +235,26 @@ static auto MakeCallback(boost::python::object callback) {
   };
 }
 
+#include "Buffer.cpp"
+#include "ImageKernels.cpp"
+#include "GeomKernels.cpp"
+#include "WorkerPool.cpp"
+#include "DiskWriter.cpp"
+#include "PointCloudWriter.cpp"
 #include "Geom.cpp"
 #include "Actor.cpp"
 #include "Blueprint.cpp"
+#include "CommandBatch.cpp"
+#include "CommandQueue.cpp"
 #include "Client.cpp"
 #include "Control.cpp"
 #include "Exception.cpp"
+#include "LaneGraph.cpp"
 #include "Map.cpp"
+#include "SensorQueue.cpp"
 #include "Sensor.cpp"
 #include "SensorData.cpp"
+#include "SensorGroup.cpp"
 #include "Snapshot.cpp"
 #include "Weather.cpp"
 #include "World.cpp"
@@ -243,12 +273,18 @@ BOOST_PYTHON_MODULE(libcarla) {
   PyEval_InitThreads();
 #endif
   scope().attr("__path__") = "libcarla";
+  export_buffer();
+  export_worker_pool();
+  export_disk_writer();
+  export_point_cloud_writer();
   export_geom();
   export_control();
   export_blueprint();
   export_actor();
+  export_sensor_queue();
   export_sensor();
   export_sensor_data();
+  export_sensor_group();
   export_snapshot();
   export_weather();
   export_world();
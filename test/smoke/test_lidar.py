@@ -8,6 +8,9 @@ from . import SyncSmokeTest
 from . import SmokeTest
 
 import carla
+import os
+import shutil
+import tempfile
 import time
 import math
 import numpy as np
@@ -78,6 +81,15 @@ class Sensor():
         if total_np_points != total_detect_points:
             self.error = "The number of points of the raw data does not match with the LidarMeasurament array"
 
+        # Zero-copy view exported through the buffer protocol
+        view = np.asarray(sensor_data)
+        if view.shape[0] != total_detect_points:
+            self.error = "The buffer view does not match with the LidarMeasurament array"
+        elif self.sensor_type == SensorType.LIDAR and not np.array_equal(view, points):
+            self.error = "The buffer view does not match with the raw data"
+        elif self.sensor_type == SensorType.SEMLIDAR and not np.array_equal(view['object_tag'], data['ObjTag']):
+            self.error = "The buffer view does not match with the raw data"
+
         if total_channel_points != total_detect_points:
             self.error = "The sum of the points of all channels does not match with the LidarMeasurament array"
 
@@ -142,6 +154,42 @@ class TestSyncLidar(SyncSmokeTest):
             if not sensor.is_correct():
                 self.fail(sensor.error)
 
+    def test_semlidar_save_formats(self):
+        print("TestSyncLidar.test_semlidar_save_formats")
+        bp_sensor = self.world.get_blueprint_library().filter("sensor.lidar.ray_cast_semantic")[0]
+        bp_sensor.set_attribute('points_per_second', '100000')
+        transform = self.world.get_map().get_spawn_points()[0]
+        transform.location.z += 3
+        sensor = self.world.spawn_actor(bp_sensor, transform)
+        measurements = Queue()
+        sensor.listen(measurements.put)
+        folder = tempfile.mkdtemp()
+        try:
+            for _ in range(0, 5):
+                self.world.tick()
+            measurement = measurements.get(timeout=10.0)
+            points = np.asarray(measurement)
+
+            path = measurement.save_to_disk(os.path.join(folder, 'cloud'), carla.PointCloudFormat.PlyBinary)
+            with open(path, 'rb') as ply_file:
+                data = ply_file.read()
+            header_size = data.index(b'end_header\n') + len(b'end_header\n')
+            saved = np.frombuffer(data[header_size:], dtype=points.dtype)
+            self.assertTrue(np.array_equal(saved, points))
+
+            path = measurement.save_to_disk(os.path.join(folder, 'cloud'), carla.PointCloudFormat.KittiBin)
+            scan = np.fromfile(path, dtype=np.float32).reshape(-1, 4)
+            labels = np.fromfile(os.path.join(folder, 'cloud.label'), dtype=np.uint32)
+            self.assertTrue(np.array_equal(scan[:, 0], points['x']))
+            self.assertTrue(np.array_equal(labels & 0xffff, points['object_tag']))
+
+            ticket = measurement.save_to_disk(
+                os.path.join(folder, 'cloud'), carla.PointCloudFormat.PcdCompressed, asynchronous=True)
+            self.assertTrue(os.path.getsize(ticket.result(10.0)) > 0)
+        finally:
+            sensor.destroy()
+            shutil.rmtree(folder)
+
 
 class TestASyncLidar(SmokeTest):
     def test_lidar_point_count(self):
@@ -5,7 +5,10 @@
 # For a copy, see <https://opensource.org/licenses/MIT>.
 
 import carla
+import os
 import random
+import shutil
+import tempfile
 
 from . import SmokeTest
 import time
@@ -31,6 +34,25 @@ class TestMap(SmokeTest):
                 self.assertEqual(map_name.split('/')[-1], m.name.split('/')[-1])
                 self._check_map(m)
 
+    def test_map_cache(self):
+        print("TestMap.test_map_cache")
+        world_map = self.client.get_world().get_map()
+        xodr = world_map.to_opendrive()
+        directory = tempfile.mkdtemp()
+        previous = carla.get_map_cache_dir()
+        try:
+            carla.set_map_cache_dir(directory)
+            self.assertEqual(carla.get_map_cache_dir(), directory)
+            built = carla.Map('cached', xodr).export_lane_graph(2.0)
+            self.assertEqual(len([f for f in os.listdir(directory) if f.endswith('.lanegraph')]), 1)
+            # Another name gives another instance, whose graph is read from the file.
+            loaded = carla.Map('cached_copy', xodr).export_lane_graph(2.0)
+            for key in ('road_id', 'lane_id', 'edges', 'edge_type'):
+                self.assertTrue((built[key] == loaded[key]).all())
+        finally:
+            carla.set_map_cache_dir(previous)
+            shutil.rmtree(directory)
+
     def _check_map(self, m):
         for spawn_point in m.get_spawn_points():
             waypoint = m.get_waypoint(spawn_point.location, project_to_road=False)
@@ -49,5 +71,50 @@ class TestMap(SmokeTest):
                 if not next_waypoints:
                     break
                 waypoint = random.choice(next_waypoints)
+        locations = [t.location for t in m.get_spawn_points()[:50]]
+        columns = m.get_waypoints(locations)
+        self.assertTrue(columns['valid'].all())
+        for row, location in enumerate(locations):
+            waypoint = m.get_waypoint(location)
+            self.assertEqual(columns['road_id'][row], waypoint.road_id)
+            self.assertEqual(columns['lane_id'][row], waypoint.lane_id)
+            self.assertAlmostEqual(columns['s'][row], waypoint.s, places=3)
+            self.assertAlmostEqual(columns['lane_width'][row], waypoint.lane_width, places=3)
+        handles, valid = m.get_waypoint_handles(locations)
+        self.assertTrue(valid.all())
+        for row, waypoint in enumerate(m.to_waypoints(handles)):
+            self.assertEqual(waypoint.handle, m.get_waypoint(locations[row]).handle)
+        invalid = handles[:1].copy()
+        invalid['lane_id'] = 0
+        self.assertEqual(m.to_waypoints(invalid), [None])
+        next_handles, index = m.next(handles, 2.0)
+        self.assertEqual(len(next_handles), len(index))
+        for row, location in enumerate(locations):
+            expected = sorted((w.road_id, w.lane_id, round(w.s, 2)) for w in m.get_waypoint(location).next(2.0))
+            found = sorted((int(h['road_id']), int(h['lane_id']), round(float(h['s']), 2)) for h in next_handles[index == row])
+            self.assertEqual(found, expected)
+        transforms = m.get_transforms(handles)
+        self.assertEqual(transforms.shape, (len(locations), 6))
+        self.assertAlmostEqual(transforms[0][0], m.get_waypoint(locations[0]).transform.location.x, places=2)
+        graph = m.export_lane_graph(2.0)
+        nodes = len(graph['s'])
+        self.assertGreater(nodes, 0)
+        self.assertEqual(graph['location'].shape, (nodes, 3))
+        self.assertEqual(graph['edges'].shape, (len(graph['edge_length']), 2))
+        self.assertTrue((graph['edges'] < nodes).all())
+        self.assertTrue((graph['edge_length'] >= 0.0).all())
+        spawn_points = m.get_spawn_points()
+        origin = spawn_points[0].location
+        destination = spawn_points[-1].location
+        route = m.plan_route(origin, destination)
+        if route:
+            self.assertIsInstance(route[0][1], carla.RoadOption)
+            self.assertLess(route[-1][0].transform.location.distance(destination), 10.0)
+        routes = m.plan_routes([origin, destination], [destination, origin], as_array=True)
+        self.assertEqual(len(routes), 2)
+        route_nodes, route_options = routes[0]
+        self.assertEqual(len(route_nodes), len(route))
+        self.assertEqual(len(route_options), len(route))
+        self.assertTrue((route_nodes < nodes).all())
         _ = m.transform_to_geolocation(carla.Location())
         self.assertTrue(str(m.to_opendrive()))
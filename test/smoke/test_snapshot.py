@@ -53,3 +53,45 @@ class TestSnapshot(SyncSmokeTest):
             self.assertAlmostEqual(t0.rotation.pitch, t1.rotation.pitch, places=2)
             self.assertAlmostEqual(t0.rotation.yaw, t1.rotation.yaw, places=2)
             self.assertAlmostEqual(t0.rotation.roll, t1.rotation.roll, places=2)
+
+        arrays = snapshot.to_arrays(ids=ids + [0])
+        self.assertEqual(list(arrays['id']), ids)
+        self.assertEqual(arrays['location'].shape, (len(ids), 3))
+        for row, actor_id in enumerate(ids):
+            actor_snapshot = snapshot.find(actor_id)
+            location = actor_snapshot.get_transform().location
+            velocity = actor_snapshot.get_velocity()
+            self.assertAlmostEqual(arrays['location'][row][0], location.x, places=3)
+            self.assertAlmostEqual(arrays['rotation'][row][1], actor_snapshot.get_transform().rotation.yaw, places=3)
+            self.assertAlmostEqual(arrays['velocity'][row][2], velocity.z, places=3)
+        self.assertEqual(len(snapshot.to_arrays()['id']), len(snapshot))
+
+        self.assertFalse(snapshot.diff(snapshot))
+        self.world.tick()
+        diff = self.world.get_snapshot().diff(snapshot)
+        self.assertEqual(len(diff.added), 0)
+        self.assertEqual(len(diff.removed), 0)
+        self.assertTrue(set(diff.changed).issubset(set(x.id for x in actors)))
+
+        snapshot = self.world.get_snapshot()
+        origin = snapshot.find(ids[0]).get_transform().location
+        nearest = snapshot.query_knn(origin, 3, ids=ids)
+        self.assertEqual(nearest[0], ids[0])
+        within = snapshot.query_radius(origin, 50.0, ids=ids)
+        for actor_id in within:
+            location = snapshot.find(actor_id).get_transform().location
+            self.assertLessEqual(location.distance(origin), 50.0 + 1e-3)
+        locations = snapshot.to_arrays(ids=ids)['location']
+        batch = snapshot.query_knn_batch(locations, 1, ids=ids)
+        self.assertEqual(list(batch[:, 0]), ids)
+
+        states = self.world.get_actor_states(ids, fields=['location'])
+        self.assertEqual(sorted(states.keys()), ['id', 'location'])
+        self.assertEqual(list(states['id']), ids)
+        vehicle = self.world.get_actor(ids[0])
+        vehicle.apply_control(carla.VehicleControl(throttle=0.5, steer=-0.25))
+        self.world.tick()
+        controls = self.world.get_vehicle_controls(ids[:1] + [0])
+        self.assertEqual(list(controls['id']), ids[:1])
+        self.assertAlmostEqual(controls['throttle'][0], vehicle.get_control().throttle, places=3)
+        self.assertAlmostEqual(controls['steer'][0], vehicle.get_control().steer, places=3)
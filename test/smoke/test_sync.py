@@ -7,6 +7,7 @@
 from . import SyncSmokeTest
 
 import carla
+import threading
 import time
 
 try:
@@ -143,6 +144,110 @@ class TestSynchronousMode(SyncSmokeTest):
             if car is not None:
                 car.destroy()
 
+    def test_listen_queue(self):
+        print("TestSynchronousMode.test_listen_queue")
+        bp = self.world.get_blueprint_library().find("sensor.other.imu")
+        imu = self.world.spawn_actor(bp, carla.Transform())
+        try:
+            queue = imu.listen_queue(maxsize=4)
+            for _ in range(0, 10):
+                self.world.tick()
+                snapshot_frame = self.world.get_snapshot().frame
+                self.assertEqual(queue.get(timeout=2.0).frame, snapshot_frame)
+            for _ in range(0, 6):
+                self.world.tick()
+            # Give time to the last measurements to arrive.
+            time.sleep(1.0)
+            batch = queue.get_batch(4, timeout=2.0)
+            self.assertEqual(len(batch), 4)
+            self.assertEqual(batch[-1].frame, self.world.get_snapshot().frame)
+            self.assertEqual(queue.dropped, 2)
+            with self.assertRaises(Empty):
+                queue.get(timeout=0.1)
+            with self.assertRaises(Empty):
+                queue.get(timeout=0.0)
+        finally:
+            imu.stop()
+            imu.destroy()
+
+    def test_listen_queue_stop_wakes_getter(self):
+        print("TestSynchronousMode.test_listen_queue_stop_wakes_getter")
+        bp = self.world.get_blueprint_library().find("sensor.other.imu")
+        imu = self.world.spawn_actor(bp, carla.Transform())
+        try:
+            queue = imu.listen_queue(maxsize=4)
+            errors = Queue()
+
+            def wait_forever():
+                try:
+                    queue.get()
+                except Empty as error:
+                    errors.put(error)
+
+            getter = threading.Thread(target=wait_forever)
+            getter.start()
+            time.sleep(0.5)
+            imu.stop()
+            getter.join(5.0)
+            self.assertFalse(getter.is_alive())
+            self.assertEqual(errors.qsize(), 1)
+        finally:
+            imu.stop()
+            imu.destroy()
+
+    def test_sensor_group(self):
+        print("TestSynchronousMode.test_sensor_group")
+        bp_lib = self.world.get_blueprint_library()
+        sensor_ids = [
+            "sensor.lidar.ray_cast",
+            "sensor.other.gnss",
+            "sensor.other.imu"]
+        trans = carla.Transform(carla.Location(z=1.7))
+        sensors = [self.world.spawn_actor(bp_lib.find(n), trans) for n in sensor_ids]
+        group = carla.SensorGroup(sensors, timeout=2.0)
+        frames = Queue()
+        try:
+            group.listen(frames.put)
+            for _ in range(0, 20):
+                self.world.tick()
+                snapshot_frame = self.world.get_snapshot().frame
+                measurements = frames.get(True, 2.0)
+                self.assertEqual(len(measurements), len(sensors))
+                for measurement in measurements:
+                    self.assertEqual(measurement.frame, snapshot_frame)
+            self.assertEqual(frames.qsize(), 0)
+            self.assertEqual(group.get_stats().delivered, 20)
+        finally:
+            group.stop()
+            for sensor in sensors:
+                sensor.destroy()
+
+    def test_sensor_group_stop_in_callback(self):
+        print("TestSynchronousMode.test_sensor_group_stop_in_callback")
+        bp_lib = self.world.get_blueprint_library()
+        trans = carla.Transform(carla.Location(z=1.7))
+        sensors = [self.world.spawn_actor(bp_lib.find(n), trans) for n in ("sensor.other.gnss", "sensor.other.imu")]
+        group = carla.SensorGroup(sensors, timeout=2.0, policy=carla.IncompleteFramePolicy.Deliver)
+        frames = Queue()
+        stopped = threading.Event()
+
+        def on_frame(measurements):
+            frames.put(measurements)
+            if frames.qsize() == 3:
+                group.stop()
+                stopped.set()
+        try:
+            group.listen(on_frame)
+            for _ in range(0, 5):
+                self.world.tick()
+            # stop() from the callback used to wait forever for its own turn.
+            self.assertTrue(stopped.wait(5.0))
+            self.assertFalse(group.is_listening)
+        finally:
+            group.stop()
+            for sensor in sensors:
+                sensor.destroy()
+
     def batch_scenario(self, batch_tick, after_tick):
         bp_veh = self.world.get_blueprint_library().filter("vehicle.*")[0]
         veh_transf = self.world.get_map().get_spawn_points()[0]
@@ -177,3 +282,27 @@ class TestSynchronousMode(SyncSmokeTest):
 
         a_t0, a_t1 = self.batch_scenario(False, True)
         self.assertEqual(a_t0+1, a_t1, "Something has failed with the apply_batch_sync. These frames should be consecutive: %d %d" % (a_t0, a_t1))
+
+    def test_apply_batch_async(self):
+        print("TestSynchronousMode.test_apply_batch_async")
+        bp_veh = self.world.get_blueprint_library().filter("vehicle.*")[0]
+        spawn_points = self.world.get_map().get_spawn_points()[:2]
+
+        frame_init = self.world.get_snapshot().frame
+        futures = [
+            self.client.apply_batch_async([carla.command.SpawnActor(bp_veh, t)])
+            for t in spawn_points]
+        frame_after = self.world.tick()
+        self.assertEqual(frame_init + 1, frame_after)
+        self.assertTrue(all(future.done() for future in futures))
+
+        ids = [future.result()[0].actor_id for future in futures]
+        self.assertNotIn(0, ids)
+
+        batch = carla.command.CommandBatch()
+        batch.destroy_actor(ids)
+        future = self.client.apply_batch_async(batch, True)
+        responses = future.result(10.0)
+        self.assertEqual(len(responses), len(ids))
+        self.assertFalse(any(x.error for x in responses))
+        self.assertEqual(self.world.get_snapshot().frame, frame_after + 1)
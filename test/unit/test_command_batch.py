@@ -0,0 +1,41 @@
+# Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+import carla
+
+import numpy as np
+import unittest
+
+
+class TestCommandBatch(unittest.TestCase):
+    def test_build_and_clear(self):
+        batch = carla.command.CommandBatch()
+        ids = np.arange(1, 5, dtype=np.uint32)
+        batch.apply_vehicle_control(ids, throttle=np.full(4, 0.5, dtype=np.float32), steer=0.0)
+        self.assertEqual(len(batch), 4)
+        batch.apply_transform(ids[:2], np.zeros((2, 6)))
+        batch.apply_target_velocity([5], [carla.Vector3D(1.0, 0.0, 0.0)])
+        batch.destroy_actor(ids)
+        batch.append(carla.command.DestroyActor(7))
+        self.assertEqual(len(batch), 12)
+        batch.clear()
+        self.assertEqual(len(batch), 0)
+
+    def test_strided_columns(self):
+        batch = carla.command.CommandBatch()
+        ids = np.arange(1, 9, dtype=np.int64)
+        actions = np.zeros((4, 3), dtype=np.float32)
+        batch.apply_vehicle_control(ids[::2], throttle=actions[:, 0], steer=actions[:, 1])
+        batch.apply_transform(ids[1::2], np.zeros((4, 12))[:, ::2])
+        self.assertEqual(len(batch), 8)
+
+    def test_invalid_columns(self):
+        batch = carla.command.CommandBatch()
+        with self.assertRaises(ValueError):
+            batch.apply_vehicle_control([1, 2], throttle=[0.5])
+        with self.assertRaises(ValueError):
+            batch.apply_transform([1, 2], np.zeros((2, 3)))
+        self.assertEqual(len(batch), 0)
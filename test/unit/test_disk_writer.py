@@ -0,0 +1,25 @@
+# Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+import carla
+
+import unittest
+
+
+class TestDiskWriter(unittest.TestCase):
+    def test_flush_when_idle(self):
+        carla.DiskWriter.configure(threads=1, queue_size=4, policy=carla.DiskWriterPolicy.DropOldest)
+        try:
+            self.assertTrue(carla.DiskWriter.flush(1.0))
+            stats = carla.DiskWriter.get_stats()
+            self.assertEqual(stats.queue_depth, 0)
+            self.assertEqual(stats.in_progress, 0)
+        finally:
+            carla.DiskWriter.configure()
+
+    def test_invalid_configuration(self):
+        with self.assertRaises(ValueError):
+            carla.DiskWriter.configure(threads=0)
@@ -194,3 +194,132 @@ class TestTransform(unittest.TestCase):
             self.assertTrue(abs(point_list[i].x - solution_list[i].x) <= error)
             self.assertTrue(abs(point_list[i].y - solution_list[i].y) <= error)
             self.assertTrue(abs(point_list[i].z - solution_list[i].z) <= error)
+
+
+    def test_transform_points_array(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("NumPy is not installed")
+        t = carla.Transform(
+            carla.Location(x=1.0, y=-2.0, z=3.0),
+            carla.Rotation(pitch=10.0, yaw=30.0, roll=-5.0))
+        points = numpy.array([[0.0, 0.0, 2.0], [0.0, 10.0, 1.0], [4.0, 18.0, 2.0]], dtype=numpy.float32)
+        result = t.transform_points(points)
+        self.assertEqual(result.dtype, numpy.float32)
+        for row, point in zip(result, points):
+            location = t.transform(carla.Location(*[float(v) for v in point]))
+            self.assertAlmostEqual(row[0], location.x, places=3)
+            self.assertAlmostEqual(row[1], location.y, places=3)
+            self.assertAlmostEqual(row[2], location.z, places=3)
+        back = t.inverse_transform_points(result.astype(numpy.float64))
+        self.assertTrue(numpy.allclose(back, points, atol=1e-3))
+        t.transform_vectors(points, out=points)
+        vector = t.transform_vector(carla.Vector3D(0.0, 10.0, 1.0))
+        self.assertAlmostEqual(points[1][1], vector.y, places=3)
+        with self.assertRaises(ValueError):
+            t.transform_points(numpy.zeros((4, 4), dtype=numpy.float32))
+
+    def test_compose_and_inverse(self):
+        error = .001
+        a = carla.Transform(
+            carla.Location(x=1.0, y=-2.0, z=3.0),
+            carla.Rotation(pitch=10.0, yaw=30.0, roll=-5.0))
+        b = carla.Transform(
+            carla.Location(x=-4.0, y=0.5, z=2.0),
+            carla.Rotation(pitch=-20.0, yaw=120.0, roll=15.0))
+        def point():
+            return carla.Location(x=2.0, y=3.0, z=-1.0)
+        composed = (a * b).transform(point())
+        expected = a.transform(b.transform(point()))
+        back = a.inverse().transform(a.transform(point()))
+        for axis in ('x', 'y', 'z'):
+            self.assertTrue(abs(getattr(composed, axis) - getattr(expected, axis)) <= error)
+            self.assertTrue(abs(getattr(back, axis) - getattr(point(), axis)) <= error)
+
+    def test_interpolation(self):
+        a = carla.Transform(carla.Location(), carla.Rotation(yaw=170.0))
+        b = carla.Transform(carla.Location(x=10.0), carla.Rotation(yaw=-170.0))
+        middle = a.lerp(b, 0.5)
+        self.assertAlmostEqual(middle.location.x, 5.0, places=4)
+        self.assertAlmostEqual(abs(middle.rotation.yaw), 180.0, places=3)
+        start = a.slerp(b, 0.0)
+        end = a.slerp(b, 1.0)
+        self.assertAlmostEqual(start.rotation.yaw, 170.0, places=3)
+        self.assertAlmostEqual(end.rotation.yaw, -170.0, places=3)
+        self.assertAlmostEqual(end.location.x, 10.0, places=4)
+
+    def test_matrix_as_array(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("NumPy is not installed")
+        t = carla.Transform(
+            carla.Location(x=1.0, y=-2.0, z=3.0),
+            carla.Rotation(pitch=10.0, yaw=30.0, roll=-5.0))
+        matrix = t.get_matrix(as_array=True)
+        self.assertEqual(matrix.shape, (4, 4))
+        self.assertEqual(matrix.dtype, numpy.float32)
+        self.assertTrue(numpy.allclose(matrix, numpy.array(t.get_matrix())))
+        identity = matrix @ t.get_inverse_matrix(as_array=True)
+        self.assertTrue(numpy.allclose(identity, numpy.eye(4), atol=1e-4))
+
+class TestBoundingBox(unittest.TestCase):
+    def test_vertices_as_array(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("NumPy is not installed")
+        bbox = carla.BoundingBox(carla.Location(1.0, 2.0, 3.0), carla.Vector3D(1.0, 2.0, 3.0))
+        t = carla.Transform(carla.Location(x=10.0))
+        vertices = bbox.get_world_vertices(t)
+        array = bbox.get_world_vertices(t, as_array=True)
+        self.assertEqual(array.dtype.names, ('x', 'y', 'z'))
+        self.assertEqual(len(array), len(vertices))
+        for row, vertex in zip(array, vertices):
+            self.assertAlmostEqual(row['x'], vertex.x, places=4)
+            self.assertAlmostEqual(row['y'], vertex.y, places=4)
+            self.assertAlmostEqual(row['z'], vertex.z, places=4)
+        self.assertEqual(len(bbox.get_local_vertices(as_array=True)), 8)
+
+    def test_batch_geometry(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("NumPy is not installed")
+        boxes = [
+            carla.BoundingBox(carla.Location(0.0, 0.0, 1.0), carla.Vector3D(2.0, 1.0, 1.0)),
+            carla.BoundingBox(carla.Location(0.0, 0.0, 1.0), carla.Vector3D(2.0, 1.0, 1.0)),
+            carla.BoundingBox(carla.Location(0.0, 0.0, 1.0), carla.Vector3D(1.0, 1.0, 1.0))]
+        transforms = [
+            carla.Transform(carla.Location(x=10.0)),
+            carla.Transform(carla.Location(x=12.5), carla.Rotation(yaw=90.0)),
+            carla.Transform(carla.Location(x=-10.0))]
+        vertices = carla.BoundingBox.get_world_vertices_batch(boxes, transforms)
+        self.assertEqual(vertices.shape, (3, 8, 3))
+        for box, transform, rows in zip(boxes, transforms, vertices):
+            for row, vertex in zip(rows, box.get_world_vertices(transform)):
+                self.assertAlmostEqual(row[0], vertex.x, places=3)
+                self.assertAlmostEqual(row[1], vertex.y, places=3)
+                self.assertAlmostEqual(row[2], vertex.z, places=3)
+        points = numpy.array([[10.0, 0.0, 1.0], [11.9, 0.9, 0.1], [-10.0, 0.5, 1.5], [0.0, 0.0, 0.0]], dtype=numpy.float32)
+        inside = carla.BoundingBox.contains_points(points, boxes, transforms)
+        self.assertEqual(inside.shape, (3, 4))
+        for i, (box, transform) in enumerate(zip(boxes, transforms)):
+            for j, point in enumerate(points):
+                location = carla.Location(*[float(v) for v in point])
+                self.assertEqual(inside[i][j], box.contains(location, transform))
+        rotated = carla.BoundingBox(carla.Location(0.0, 0.0, 1.0), carla.Vector3D(2.0, 1.0, 1.0))
+        rotated.rotation = carla.Rotation(yaw=45.0)
+        # Inside the box rotated by 45 degrees, outside the same box unrotated.
+        point = numpy.array([[1.2, 1.2, 1.0]])
+        self.assertTrue(carla.BoundingBox.contains_points(point, [rotated])[0][0])
+        self.assertFalse(carla.BoundingBox.contains_points(point, [boxes[0]])[0][0])
+        self.assertFalse(rotated.contains(carla.Location(1.2, 1.2, 1.0), carla.Transform()))
+        overlaps = carla.BoundingBox.get_overlaps(boxes, transforms)
+        self.assertTrue((overlaps == numpy.array([
+            [True, True, False],
+            [True, True, False],
+            [False, False, True]])).all())
+        with self.assertRaises(ValueError):
+            carla.BoundingBox.get_overlaps(boxes, transforms[:2])
@@ -0,0 +1,22 @@
+# Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+import carla
+
+import unittest
+
+
+class TestWorkerPool(unittest.TestCase):
+    def test_set_worker_threads(self):
+        previous = carla.get_worker_threads()
+        try:
+            carla.set_worker_threads(0)
+            self.assertEqual(carla.get_worker_threads(), 0)
+            carla.set_worker_threads(3)
+            self.assertEqual(carla.get_worker_threads(), 3)
+        finally:
+            carla.set_worker_threads(previous)
+        self.assertEqual(carla.get_worker_threads(), previous)